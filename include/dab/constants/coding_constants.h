@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_CONSTANTS_CODING_CONSTANTS
+#define DABIP_CONSTANTS_CODING_CONSTANTS
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace constants
+      {
+
+      /**
+       * The generator polynomials of the rate 1/4 mother code, in the order of the outputs
+       */
+      std::uint8_t constexpr kMotherCodePolynomials[] {0133, 0171, 0145, 0133};
+      std::uint8_t constexpr kMotherCodeMemory {6};
+
+      /**
+       * The mother code polynomials for a shift register holding the current bit in bit 0 and the oldest in bit 6
+       */
+      std::uint8_t constexpr kMotherCodeTaps[] {0155, 0117, 0123, 0155};
+
+      /**
+       * The puncturing vectors PI_1 to PI_24 applied to each 32 bit sub-block of the mother code, first bit in the MSB
+       */
+      std::uint32_t constexpr kPuncturingVectors[] {
+        0xC8888888, 0xC888C888, 0xC8C8C888, 0xC8C8C8C8, 0xCCC8C8C8, 0xCCC8CCC8, 0xCCCCCCC8, 0xCCCCCCCC,
+        0xECCCCCCC, 0xECCCECCC, 0xECECECCC, 0xECECECEC, 0xEEECECEC, 0xEEECEEEC, 0xEEEEEEEC, 0xEEEEEEEE,
+        0xFEEEEEEE, 0xFEEEFEEE, 0xFEFEFEEE, 0xFEFEFEFE, 0xFFFEFEFE, 0xFFFEFFFE, 0xFFFFFFFE, 0xFFFFFFFF,
+      };
+
+      /**
+       * The puncturing vector applied to the 24 bits encoding the tail, first bit in the MSB of the 32 bit word
+       */
+      std::uint32_t constexpr kTailPuncturingVector {0xCCCCCC00};
+      std::uint8_t constexpr kTailBits {24};
+
+      /**
+       * The puncturing vector indices of the FIC, used for all but the last three blocks, and for these
+       */
+      std::uint8_t constexpr kFICPuncturing {16};
+      std::uint8_t constexpr kFICFinalPuncturing {15};
+
+      }
+
+    }
+
+  }
+
+#endif
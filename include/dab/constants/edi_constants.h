@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_CONSTANTS_EDI_CONSTANTS
+#define DABIP_CONSTANTS_EDI_CONSTANTS
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace constants
+      {
+
+      std::uint8_t constexpr kAFHeaderSize {10};
+      std::uint8_t constexpr kAFRevision {0x90}; //CRC flag, major revision 1, minor revision 0
+      std::uint8_t constexpr kAFProtocolTypeTag {'T'};
+      std::uint8_t constexpr kTagHeaderSize {8};
+      std::uint16_t constexpr kDLFCModulus {5000};
+      std::uint8_t constexpr kTAIOffsetBias {32};
+      std::uint32_t constexpr kTimestampTicksPerSecond {16384000};
+      std::uint32_t constexpr kEpoch2000 {946684800};
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_CONSTANTS_ETI_CONSTANTS
+#define DABIP_CONSTANTS_ETI_CONSTANTS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace constants
+      {
+
+      std::size_t constexpr kETIFrameSize {6144};
+      std::uint32_t constexpr kETIFsyncEven {0x073AB6};
+      std::uint32_t constexpr kETIFsyncOdd {0xF8C549};
+      std::uint8_t constexpr kETIFrameCountModulus {250};
+      std::uint8_t constexpr kETIMaxStreams {64};
+      std::uint8_t constexpr kETIFramePadding {0x55};
+      std::uint8_t constexpr kFIBSize {32};
+      std::uint8_t constexpr kFIBEndMarker {0xFF};
+      std::uint16_t constexpr kCapacityUnits {864};
+      std::uint8_t constexpr kEEPAUnitsPer8kbps[] {12, 8, 6, 4};
+      std::uint8_t constexpr kEEPBUnitsPer32kbps[] {27, 21, 18, 15};
+
+      }
+
+    }
+
+  }
+
+#endif
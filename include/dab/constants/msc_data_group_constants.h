@@ -41,6 +41,7 @@ namespace dab
     namespace constants
       {
       std::uint8_t constexpr kDataGroupTypes[] {0, 1, 2};
+      std::uint16_t constexpr kMaxDatagramSize {8191};
       }
     }
   }
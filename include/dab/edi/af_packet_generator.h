@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_EDI_AF_PACKET_GENERATOR
+#define DABIP_EDI_AF_PACKET_GENERATOR
+
+#include <dab/types/common_types.h>
+
+#include <cstdint>
+#include <string>
+
+namespace dab
+  {
+
+  /**
+   * @brief The parameters of the ETI frame described by a deti TAG item.
+   *
+   * @since 1.1.0
+   **/
+  struct deti_parameters
+    {
+    std::uint16_t frame_count; ///< The logical frame count (DLFC) in the range [0, 4999]
+    std::uint8_t mode_id; ///< The transmission mode identifier (MID)
+    std::uint8_t utc_offset; ///< The TAI-UTC offset minus 32 (UTCO)
+    std::uint32_t seconds; ///< The TAI seconds since 2000-01-01T00:00:00
+    std::uint32_t ticks; ///< The fraction of the second in units of 1/16384000s (TSTA)
+    };
+
+  /**
+   * @brief The parameters of a sub-channel stream described by an est<n> TAG item.
+   *
+   * @since 1.1.0
+   **/
+  struct est_parameters
+    {
+    std::uint8_t stream_index; ///< The index n of the est<n> TAG item
+    std::uint8_t subchannel_id; ///< The sub-channel identifier (SCID)
+    std::uint16_t start_address; ///< The sub-channel start address (SAD)
+    std::uint8_t protection; ///< The sub-channel type and protection level (TPL)
+    };
+
+  /**
+   * @brief Builds a TAG item from its name and value.
+   */
+  byte_vector_t build_tag_item(std::string const & name, byte_vector_t const & value);
+
+  /**
+   * @brief Builds the *ptr TAG item announcing the DETI protocol.
+   */
+  byte_vector_t build_ptr_tag();
+
+  /**
+   * @brief Builds a timestamped deti TAG item without FIC.
+   */
+  byte_vector_t build_deti_tag(deti_parameters const & parameters);
+
+  /**
+   * @brief Builds an est<n> TAG item carrying the data of a sub-channel for one frame.
+   */
+  byte_vector_t build_est_tag(est_parameters const & parameters, byte_vector_t const & data);
+
+  /**
+   * @brief A generator for EDI AF packets.
+   *
+   * @since 1.1.0
+   **/
+  struct af_packet_generator
+    {
+    /**
+     * @brief Wraps TAG items into an AF packet with sequence number and CRC.
+     * @param tag_items The concatenated TAG items.
+     * @return The AF packet.
+     */
+    byte_vector_t build(byte_vector_t const & tag_items);
+
+    private:
+    std::uint16_t m_sequence {};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_EDI_PFT_GENERATOR
+#define DABIP_EDI_PFT_GENERATOR
+
+#include <dab/types/common_types.h>
+#include <dab/util/reed_solomon.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A generator splitting EDI AF packets into PFT fragments.
+   *
+   * If Reed-Solomon protection is enabled, the AF packet is split into chunks of at most 207 bytes, each
+   * followed by 48 bytes of parity. The protected block is then interleaved across the fragments in a way
+   * that allows the receiver to recover from the loss of up to @p recoverable fragments.
+   *
+   * @since 1.1.0
+   **/
+  struct pft_generator
+    {
+    /**
+     * @brief The most lost fragments a receiver can recover from, so that even a block of a single chunk
+     * spreads its parity across enough fragments.
+     */
+    static std::uint8_t constexpr kMaxRecoverable{internal::reed_solomon_encoder::kParityLength - 1};
+
+    /**
+     * @param recoverable The number of lost fragments the receiver can recover from, 0 disables FEC.
+     * @param max_fragment_size The maximum payload size of a single fragment.
+     * @throws std::invalid_argument if the fragment size or the number of recoverable fragments is out of range
+     **/
+    pft_generator(std::uint8_t recoverable, std::size_t max_fragment_size);
+
+    /**
+     * @brief Splits an AF packet into PFT fragments.
+     * @return The fragments including their PF headers.
+     */
+    std::vector<byte_vector_t> build(byte_vector_t const & af_packet);
+
+    private:
+
+    /**
+     * @internal
+     *
+     * @brief Generates the PF header for a single fragment.
+     **/
+    byte_vector_t build_header(std::uint32_t index, std::uint32_t count, std::size_t length, std::uint8_t chunk_length, std::uint8_t padding) const;
+
+    std::uint8_t const kRecoverable;
+    std::size_t const kMaxFragmentSize;
+    std::uint16_t m_sequence {};
+    internal::reed_solomon_encoder m_encoder {};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_ETI_ETI_FRAME_GENERATOR
+#define DABIP_ETI_ETI_FRAME_GENERATOR
+
+#include <dab/edi/af_packet_generator.h>
+#include <dab/types/common_types.h>
+#include <dab/types/transmission_mode.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A sub-channel carried in an ETI frame.
+   *
+   * @since 1.1.0
+   **/
+  struct eti_subchannel
+    {
+    est_parameters stream; ///< The sub-channel identifier, start address and protection, the stream index is unused
+    std::uint16_t bitrate; ///< The capacity of the sub-channel in kbit/s, a multiple of 8
+    };
+
+  /**
+   * @brief A generator for ETI(NI) frames according to ETSI EN 300 799.
+   *
+   * The frame buffer is allocated once, with everything but the counters, the sub-channel data and the CRCs
+   * filled in. The FIC carries empty FIBs. Every 24ms, the sub-channel data is written straight into the
+   * frame, which #build then completes.
+   *
+   * @since 1.1.0
+   **/
+  struct eti_frame_generator
+    {
+    /**
+     * @param mode The transmission mode, which determines the size of the FIC.
+     * @param subchannels The EEP protected sub-channels, which must not overlap in the CIF.
+     * @throws std::invalid_argument if the sub-channels do not fit into the CIF or the frame.
+     */
+    eti_frame_generator(internal::types::transmission_mode const & mode, std::vector<eti_subchannel> const & subchannels);
+
+    /**
+     * @brief The data of a sub-channel in the next frame.
+     * @param index The index of the sub-channel, in the order given on construction.
+     * @return The #subchannel_size bytes of the sub-channel.
+     */
+    std::uint8_t * subchannel_data(std::size_t index);
+
+    /**
+     * @brief The number of bytes a sub-channel carries per frame.
+     */
+    std::size_t subchannel_size(std::size_t index) const;
+
+    /**
+     * @brief Completes the next frame.
+     * @return The frame, valid until the next call to #subchannel_data or #build.
+     */
+    byte_vector_t const & build();
+
+    private:
+    byte_vector_t m_frame;
+    std::vector<std::size_t> m_offsets{};
+    std::vector<std::size_t> m_sizes{};
+    std::size_t m_header_end{};
+    std::size_t m_main_stream_end{};
+    std::uint32_t m_frame_count{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_HEADER_COMPRESSION_HEADER_COMPRESSOR
+#define DABIP_HEADER_COMPRESSION_HEADER_COMPRESSOR
+
+#include <dab/types/buffer_chain.h>
+#include <dab/types/common_types.h>
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  /**
+   * @brief A generator for static-context compressed UDP datagrams.
+   *
+   * Instead of a full 28 byte IPv4/UDP header, every compressed datagram only carries the one byte
+   * ID of its header context, followed by the two byte payload length and the payload itself.
+   *
+   * @since 1.1.0
+   **/
+  struct header_compressor
+    {
+    /**
+     * @param context_id The ID of the header context the receiver uses to restore the header.
+     **/
+    header_compressor(std::uint8_t context_id);
+
+    /**
+     * @brief Builds a compressed datagram from a UDP payload.
+     * @param payload A UDP payload of max size 65507 bytes.
+     * @return The compressed datagram.
+     */
+    byte_vector_t build(byte_vector_t const & payload) const;
+
+    /**
+     * @brief Turns a UDP payload into a compressed datagram by writing the header into its headroom.
+     * @param payload A UDP payload of max size 65507 bytes.
+     */
+    void build(iobuf & payload) const;
+
+    private:
+    std::uint8_t const kContextId;
+    };
+
+  }
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_HEADER_COMPRESSION_HEADER_DECOMPRESSOR
+#define DABIP_HEADER_COMPRESSION_HEADER_DECOMPRESSOR
+
+#include <dab/header_compression/header_context.h>
+#include <dab/types/common_types.h>
+
+#include <cstdint>
+#include <map>
+
+namespace dab
+  {
+
+  /**
+   * @brief A parser restoring IPv4/UDP datagrams from static-context compressed datagrams.
+   *
+   * @since 1.1.0
+   **/
+  struct header_decompressor
+    {
+    /**
+     * @brief Registers the header context with the given ID.
+     */
+    void add_context(std::uint8_t context_id, header_context const & context);
+
+    /**
+     * @brief Parses a compressed datagram.
+     * @param compressed A datagram as produced by dab::header_compressor.
+     * @return[first] A flag indicating the status of the parser.
+     * @return[second] If first==parse_status::ok the restored IP datagram else an empty byte_vector_t.
+     */
+    pair_status_vector_t parse(byte_vector_t const & compressed);
+
+    private:
+
+    /**
+     * @internal
+     *
+     * @brief Generates the IPv4 and UDP headers for a payload of the given size.
+     *
+     * The headers carry the same fixed identification as those of dab::udp_datagram_generator, so that a
+     * restored datagram does not depend on what the decompressor restored before.
+     */
+    byte_vector_t build_header(header_context const & context, std::uint16_t payload_length) const;
+
+    std::map<std::uint8_t, header_context> m_contexts {};
+    };
+
+  }
+
+#endif
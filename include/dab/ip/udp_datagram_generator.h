@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_IP_UDP_DATAGRAM_GENERATOR
+#define DABIP_IP_UDP_DATAGRAM_GENERATOR
+
+#include <dab/header_compression/header_context.h>
+#include <dab/types/buffer_chain.h>
+#include <dab/types/common_types.h>
+
+namespace dab
+  {
+
+  /**
+   * @brief A generator for IPv4/UDP datagrams with a fixed set of addresses and ports.
+   *
+   * The headers are written straight into the datagram, which carries the identification 1 and the TTL 128
+   * like the ones libtins serializes.
+   *
+   * @since 1.1.0
+   **/
+  struct udp_datagram_generator
+    {
+    /**
+     * @param context The addresses and ports of the datagrams.
+     **/
+    explicit udp_datagram_generator(header_context const & context);
+
+    /**
+     * @brief Builds an IPv4/UDP datagram around a payload.
+     * @param payload A UDP payload of max size 65507 bytes.
+     * @return The datagram, including the IPv4 and UDP checksums.
+     */
+    byte_vector_t build(byte_vector_t const & payload) const;
+
+    /**
+     * @brief Turns a payload into an IPv4/UDP datagram by writing the headers into its headroom.
+     * @param payload A UDP payload of max size 65507 bytes.
+     */
+    void build(iobuf & payload) const;
+
+    private:
+    header_context const kContext;
+    };
+
+  }
+
+#endif
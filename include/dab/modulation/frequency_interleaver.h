@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_MODULATION_FREQUENCY_INTERLEAVER
+#define DABIP_MODULATION_FREQUENCY_INTERLEAVER
+
+#include <dab/types/common_types.h>
+#include <dab/types/transmission_mode.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @brief The frequency interleaver of a transmission mode according to ETSI EN 300 401 clause 14.6.
+     *
+     * The permutation generated by PI(i) = (13 PI(i - 1) + fft_length / 4 - 1) mod fft_length is
+     * precomputed once, directly as the FFT bins the QPSK symbols are placed on. Carrier k is held by bin
+     * k mod fft_length, and the bins of the DC carrier and the guard band stay empty.
+     *
+     * @since 1.1.0
+     **/
+    struct frequency_interleaver
+      {
+      explicit frequency_interleaver(types::transmission_mode const & mode);
+
+      /**
+       * @brief Interleaves the OFDM symbols of a CIF.
+       * @param symbols The #symbols_per_cif times transmission_mode::carriers QPSK symbols of the CIF.
+       * @param[out] bins The #symbols_per_cif times transmission_mode::fft_length FFT bins.
+       */
+      void interleave(sample_t const * symbols, sample_t * bins) const;
+
+      /**
+       * @brief The FFT bin of each QPSK symbol of an OFDM symbol.
+       */
+      std::vector<std::uint16_t> const & table() const;
+
+      /**
+       * @brief The number of OFDM symbols carrying a CIF.
+       */
+      std::size_t symbols_per_cif() const;
+
+      private:
+      std::vector<std::uint16_t> m_table{};
+      std::size_t m_fft_length;
+      std::size_t m_symbols_per_cif;
+      };
+
+    }
+
+  }
+
+#endif
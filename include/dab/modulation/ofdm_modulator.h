@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_MODULATION_OFDM_MODULATOR
+#define DABIP_MODULATION_OFDM_MODULATOR
+
+#include <dab/types/common_types.h>
+#include <dab/types/transmission_mode.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A generator for DAB baseband transmission frames according to ETSI EN 300 401 clause 14.
+   *
+   * Each frame starts with the null symbol and the phase reference symbol, followed by the DQPSK
+   * modulated data symbols. The carriers are frequency interleaved, transformed by an inverse FFT of
+   * transmission_mode::fft_length and preceded by their guard interval. The resulting samples at 2.048 MS/s
+   * are normalized to unit mean power.
+   *
+   * The phases of all carriers are multiples of pi/4, so the differential modulation only adds phase
+   * indices. Four OFDM symbols are transformed at once, one per SIMD lane, which shares every twiddle
+   * factor between the lanes. All buffers are allocated on construction.
+   *
+   * @since 1.1.0
+   **/
+  struct ofdm_modulator
+    {
+    explicit ofdm_modulator(internal::types::transmission_mode const & mode);
+
+    /**
+     * @brief The number of bytes modulated into a frame.
+     *
+     * These are the transmission_mode::frame_symbols times transmission_mode::symbol_bits bits of the FIC
+     * codewords followed by the time interleaved CIFs, most significant bit first.
+     */
+    std::size_t frame_size() const;
+
+    /**
+     * @brief Modulates the next transmission frame.
+     * @param bits The #frame_size bytes of the frame.
+     * @param samples The queue to append the transmission_mode::frame_duration samples of the frame to.
+     */
+    void modulate(std::uint8_t const * bits, sample_queue_t & samples);
+
+    private:
+    void load(std::size_t symbol, std::size_t lane, std::uint8_t const * bits);
+
+    void transform();
+
+    void store(std::size_t symbol, std::size_t lane);
+
+    internal::types::transmission_mode const m_mode;
+    std::vector<std::uint16_t> m_bins{};
+    std::vector<std::uint8_t> m_reference{};
+    std::vector<std::uint8_t> m_phases{};
+    std::vector<sample_t> m_constellation{};
+    std::vector<sample_t> m_twiddles{};
+    std::vector<float> m_real{};
+    std::vector<float> m_imag{};
+    std::vector<sample_t> m_samples{};
+    };
+
+  }
+
+#endif
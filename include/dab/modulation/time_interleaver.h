@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_MODULATION_TIME_INTERLEAVER
+#define DABIP_MODULATION_TIME_INTERLEAVER
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @brief The time interleaver of a sub-channel according to ETSI EN 300 401 clause 12.
+     *
+     * Bit i of a punctured codeword is delayed by the bit reversal of i mod 16 logical frames. Instead of
+     * one queue per bit index, the last 16 codewords are kept in a single circular buffer, which stores
+     * the 16 versions of each 64 bit word next to each other. Interleaving a word then only touches its own
+     * two cache lines, merging the 16 versions through precomputed masks. Until 15 codewords have passed,
+     * the delayed bits are zero.
+     *
+     * @since 1.1.0
+     **/
+    struct time_interleaver
+      {
+      /**
+       * @param size The number of bytes in a codeword, a multiple of 8 as a capacity unit holds 8 bytes.
+       * @throws std::invalid_argument if the size is not a multiple of 8.
+       */
+      explicit time_interleaver(std::size_t size);
+
+      /**
+       * @brief Interleaves the codeword of the next logical frame.
+       * @param input The #size bytes of the codeword, most significant bit first.
+       * @param[out] output The #size interleaved bytes.
+       */
+      void interleave(std::uint8_t const * input, std::uint8_t * output);
+
+      /**
+       * @brief The number of bytes in a codeword.
+       */
+      std::size_t size() const;
+
+      private:
+      std::vector<std::uint64_t> m_delay_lines;
+      std::array<std::uint64_t, 16> m_masks{};
+      std::uint8_t m_frame{};
+      };
+
+    }
+
+  }
+
+#endif
@@ -34,6 +34,7 @@
 
 #include <cstdint>
 
+#include <dab/types/buffer_chain.h>
 #include <dab/types/common_types.h>
 
 namespace dab
@@ -56,6 +57,18 @@ namespace dab
      */
     byte_vector_t build(byte_vector_t & ip_datagram);
 
+    /**
+     * @brief Turns ip_datagram into a MSC data group in place
+     *
+     * The header is written into the headroom and the CRC into the tailroom of the buffer, so the datagram
+     * itself is not moved.
+     *
+     * @param ip_datagram An IP datagram of max size 8191 bytes.
+     *
+     * @since 1.1.0
+     */
+    void build(iobuf & ip_datagram);
+
     private:
 
     /**
@@ -66,7 +79,7 @@ namespace dab
      * @brief Generates the MSC data group header.
      *
      **/
-    byte_vector_t build_header();
+    void build_header(std::uint8_t * header);
 
     byte_vector_t m_last_ip_datagram {};
     std::uint8_t m_continuity_index {15};
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_PACKET_PACKET_ENCODER
+#define DABIP_PACKET_PACKET_ENCODER
+
+#include <dab/constants/packet_constants.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @brief The three header bytes of a DAB packet.
+     */
+    using packet_header_t = std::array<std::uint8_t, 3>;
+
+    /**
+     * @brief An encoder for the DAB packets of one of the four packet lengths.
+     *
+     * Everything but the continuity index, the first/last flags and the useful data length of a header is
+     * fixed for a given length and address. The encoder therefore starts from a pattern precomputed per
+     * address and only ORs in the fields changing from packet to packet.
+     *
+     * @tparam LengthClass The index of the packet length in constants::kPacketLengths.
+     *
+     * @since 1.1.0
+     */
+    template<std::size_t LengthClass>
+      struct packet_encoder
+        {
+        static_assert(LengthClass < 4, "there are only four DAB packet lengths");
+
+        static std::uint8_t constexpr kLength{constants::kPacketLengths[LengthClass]};
+        static std::uint8_t constexpr kDataLength{constants::kPacketDataLengths[LengthClass]};
+
+        /**
+         * @brief Computes the header fields that are the same for every packet to the given address.
+         * @param address An integer in the interval [1,1023].
+         */
+        static constexpr packet_header_t pattern(std::uint16_t address)
+          {
+          return packet_header_t{{
+            static_cast<std::uint8_t>(LengthClass << 6 | (address >> 8 & 0x03)),
+            static_cast<std::uint8_t>(address),
+            0,
+          }};
+          }
+
+        /**
+         * @brief Writes a packet header.
+         * @param header Room for the three header bytes.
+         * @param pattern The result of pattern() for the address of the packet.
+         */
+        static void encode_header(std::uint8_t * header, packet_header_t const & pattern, std::uint8_t continuity_index,
+                                  std::uint8_t first_last, std::uint8_t useful_data_length)
+          {
+          std::memcpy(header, pattern.data(), pattern.size());
+          header[0] |= continuity_index << 4 | first_last << 2;
+          header[2] |= useful_data_length;
+          }
+        };
+
+    template<std::size_t LengthClass>
+      std::uint8_t constexpr packet_encoder<LengthClass>::kLength;
+
+    template<std::size_t LengthClass>
+      std::uint8_t constexpr packet_encoder<LengthClass>::kDataLength;
+
+    }
+
+  }
+
+#endif
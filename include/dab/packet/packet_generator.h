@@ -32,8 +32,12 @@
 #ifndef DABIP_PACKET_PACKET_GENERATOR
 #define DABIP_PACKET_PACKET_GENERATOR
 
+#include <dab/packet/packet_encoder.h>
+#include <dab/types/buffer_chain.h>
 #include <dab/types/common_types.h>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 namespace dab
@@ -63,34 +67,35 @@ namespace dab
      */
     byte_vector_t build(byte_vector_t & msc_data_group);
 
-    private:
-
     /**
-     * @internal
+     * @brief Builds dab packets from msc data group without copying it.
      *
-     * @author Tobias Stauber
+     * The packet headers and CRCs are gathered around slices of the data group, which the returned chain
+     * takes ownership of.
      *
-     * @brief Builds dab packet header
+     * @return A buffer_chain containing one ore more DAB packets.
      *
-     * @return The header for the DAB packet.
+     * @since 1.1.0
      */
-    byte_vector_t build_header(std::uint8_t const packet_length, std::uint8_t const useful_data_length);
+    buffer_chain build(iobuf && msc_data_group);
+
+    private:
 
     /**
      * @internal
      *
-     * @author Tobias Stauber
-     *
-     * @brief Assembles packets
+     * @brief Assembles a packet of the given length class around a slice of a MSC data group
      *
-     * @return The assembled DAB packet.
+     * @param overhead Room for the 3 byte header and the 2 byte CRC of the packet, in that order.
      */
-    byte_vector_t assemble(byte_vector_t & msc_data_group, std::uint8_t packet_length);
+    template<std::size_t LengthClass>
+    void assemble(buffer_chain & packets, std::uint8_t * overhead, std::uint8_t const * data, std::uint8_t length);
 
     void set_first_last();
 
     std::uint8_t m_first_last = 3;
     std::uint16_t const kAddress;
+    std::array<internal::packet_header_t, 4> const kHeaderPatterns;
     std::uint8_t m_continuity_index {};
     };
 }
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_BOUNDED_QUEUE
+#define DABCOMMON_TYPES_BOUNDED_QUEUE
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief A lock-free bounded MPMC queue
+     *
+     * Every slot carries a sequence number telling producers and consumers whether it is free or filled for the
+     * current lap, so that an operation only ever contends on the position counter of its own side. Neither
+     * side blocks, a full or empty queue is reported to the caller instead.
+     *
+     * @tparam ValueType The type of the elements contained in queue
+     *
+     * @since  1.1.0
+     */
+    template<typename ValueType>
+    struct bounded_queue
+      {
+      using value_type = ValueType;
+
+      /**
+       * @brief Construct an empty queue
+       *
+       * @param capacity The number of elements the queue can hold, a power of two
+       *
+       * @throws std::invalid_argument if the capacity is not a power of two
+       */
+      explicit bounded_queue(std::size_t const capacity)
+        : m_mask{capacity - 1}
+        , m_cells{new cell[capacity]}
+        {
+        if(capacity < 2 || (capacity & m_mask))
+          {
+          throw std::invalid_argument{"queue capacity must be a power of two"};
+          }
+
+        for(auto idx = std::size_t{}; idx < capacity; ++idx)
+          {
+          m_cells[idx].sequence.store(idx, std::memory_order_relaxed);
+          }
+        }
+
+      bounded_queue(bounded_queue const &) = delete;
+      bounded_queue & operator=(bounded_queue const &) = delete;
+
+      /**
+       * @brief Try to enqueue an element
+       *
+       * @return false if the queue is full, in which case the element is left untouched
+       */
+      bool try_enqueue(value_type && elem)
+        {
+        auto position = m_enqueuePosition.load(std::memory_order_relaxed);
+
+        while(true)
+          {
+          auto & slot = m_cells[position & m_mask];
+          auto const sequence = slot.sequence.load(std::memory_order_acquire);
+          auto const lap = static_cast<std::ptrdiff_t>(sequence - position);
+
+          if(!lap && m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+            slot.value = std::move(elem);
+            slot.sequence.store(position + 1, std::memory_order_release);
+            return true;
+            }
+          else if(lap < 0)
+            {
+            return false;
+            }
+          else if(lap)
+            {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+          }
+        }
+
+      /**
+       * @brief Try to dequeue an element
+       *
+       * @return false if the queue is empty
+       */
+      bool try_dequeue(value_type & elem)
+        {
+        auto position = m_dequeuePosition.load(std::memory_order_relaxed);
+
+        while(true)
+          {
+          auto & slot = m_cells[position & m_mask];
+          auto const sequence = slot.sequence.load(std::memory_order_acquire);
+          auto const lap = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+          if(!lap && m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+            elem = std::move(slot.value);
+            slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+            return true;
+            }
+          else if(lap < 0)
+            {
+            return false;
+            }
+          else if(lap)
+            {
+            position = m_dequeuePosition.load(std::memory_order_relaxed);
+            }
+          }
+        }
+
+      /**
+       * @brief Get the approximate number of elements in the queue
+       */
+      std::size_t approximate_size() const
+        {
+        auto const enqueued = m_enqueuePosition.load(std::memory_order_relaxed);
+        auto const dequeued = m_dequeuePosition.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+      /**
+       * @brief Get the number of elements the queue can hold
+       */
+      std::size_t capacity() const
+        {
+        return m_mask + 1;
+        }
+
+      private:
+        struct cell
+          {
+          std::atomic<std::size_t> sequence;
+          value_type value;
+          };
+
+        // Keep the producer and consumer positions on cache lines of their own
+        using padding = char[64];
+
+        std::size_t const m_mask;
+        std::unique_ptr<cell[]> const m_cells;
+        padding m_padding0;
+        std::atomic<std::size_t> m_enqueuePosition{};
+        padding m_padding1;
+        std::atomic<std::size_t> m_dequeuePosition{};
+        padding m_padding2;
+      };
+
+    }
+
+  }
+
+#endif
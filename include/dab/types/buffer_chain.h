@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_BUFFER_CHAIN
+#define DABCOMMON_TYPES_BUFFER_CHAIN
+
+#include "dab/types/common_types.h"
+#include "dab/types/pool_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A contiguous byte buffer with room to grow at both ends.
+   *
+   * Headers are prepended into the headroom and trailers appended into the tailroom, so wrapping a payload
+   * layer by layer never moves it. Only running out of room reallocates.
+   *
+   * @since  1.1.0
+   */
+  struct iobuf
+    {
+    /**
+     * @brief The headroom left in front of a payload by default, enough for an IPv4/UDP header and an MSC
+     * data group header.
+     */
+    static std::size_t constexpr kDefaultHeadroom{32};
+
+    /**
+     * @brief The tailroom left behind a payload by default, enough for the MSC data group CRC.
+     */
+    static std::size_t constexpr kDefaultTailroom{16};
+
+    iobuf() = default;
+
+    /**
+     * @brief Construct a buffer holding size zero bytes.
+     */
+    explicit iobuf(std::size_t size, std::size_t headroom = kDefaultHeadroom, std::size_t tailroom = kDefaultTailroom);
+
+    /**
+     * @brief Replace the contents, leaving the default headroom and tailroom around them.
+     */
+    template<typename InputIterator>
+    void assign(InputIterator first, InputIterator last)
+      {
+      m_storage.resize(kDefaultHeadroom);
+      m_storage.insert(m_storage.end(), first, last);
+      m_begin = kDefaultHeadroom;
+      m_end = m_storage.size();
+      m_storage.resize(m_end + kDefaultTailroom);
+      }
+
+    /**
+     * @brief Grow or shrink the buffer at its end, taking the room from the tailroom if possible.
+     *
+     * Bytes added by growing the buffer are zero.
+     */
+    void resize(std::size_t size);
+
+    /**
+     * @brief Grow the buffer at its front.
+     *
+     * The bytes added are left as they were in the headroom, the caller is expected to overwrite them.
+     *
+     * @return The first of the count bytes added.
+     */
+    std::uint8_t * prepend(std::size_t count);
+
+    /**
+     * @brief Grow the buffer at its end.
+     *
+     * The bytes added are zero, see #resize.
+     *
+     * @return The first of the count bytes added.
+     */
+    std::uint8_t * append(std::size_t count);
+
+    std::uint8_t * data()
+      {
+      return m_storage.data() + m_begin;
+      }
+
+    std::uint8_t const * data() const
+      {
+      return m_storage.data() + m_begin;
+      }
+
+    std::uint8_t * begin()
+      {
+      return data();
+      }
+
+    std::uint8_t const * begin() const
+      {
+      return data();
+      }
+
+    std::uint8_t * end()
+      {
+      return m_storage.data() + m_end;
+      }
+
+    std::uint8_t const * end() const
+      {
+      return m_storage.data() + m_end;
+      }
+
+    std::uint8_t & operator[](std::size_t index)
+      {
+      return data()[index];
+      }
+
+    std::uint8_t operator[](std::size_t index) const
+      {
+      return data()[index];
+      }
+
+    std::size_t size() const
+      {
+      return m_end - m_begin;
+      }
+
+    bool empty() const
+      {
+      return m_end == m_begin;
+      }
+
+    std::size_t headroom() const
+      {
+      return m_begin;
+      }
+
+    std::size_t tailroom() const
+      {
+      return m_storage.size() - m_end;
+      }
+
+    private:
+    internal::pooled_byte_vector_t m_storage{};
+    std::size_t m_begin{};
+    std::size_t m_end{};
+    };
+
+  /**
+   * @brief A sequence of byte ranges forming one logical buffer.
+   *
+   * The ranges either point into buffers the chain holds, or into memory that outlives the chain. Ranges
+   * adjacent in memory are merged as they are appended, and the whole chain is meant to end up in a single
+   * gather write.
+   *
+   * @since  1.1.0
+   */
+  struct buffer_chain
+    {
+    /**
+     * @brief A range of bytes in the chain.
+     */
+    struct segment
+      {
+      std::uint8_t const * data;
+      std::size_t size;
+      };
+
+    using segments_t = std::vector<segment, internal::pool_allocator<segment>>;
+
+    /**
+     * @brief Take ownership of a buffer, without adding its contents to the chain.
+     * @return The buffer as held by the chain, its bytes stay in place for as long as the chain exists.
+     */
+    iobuf const & hold(iobuf && buffer);
+
+    /**
+     * @brief Append a range of bytes, which must outlive the chain or be part of a buffer it holds.
+     */
+    void append(std::uint8_t const * data, std::size_t size);
+
+    /**
+     * @brief Take ownership of a buffer and append its contents.
+     */
+    void append(iobuf && buffer);
+
+    /**
+     * @brief Copy the contents of the chain into a contiguous buffer.
+     */
+    void copy_to(byte_vector_t & target) const;
+
+    segments_t const & segments() const
+      {
+      return m_segments;
+      }
+
+    std::size_t size() const
+      {
+      return m_size;
+      }
+
+    bool empty() const
+      {
+      return !m_size;
+      }
+
+    private:
+    std::vector<iobuf, internal::pool_allocator<iobuf>> m_buffers{};
+    segments_t m_segments{};
+    std::size_t m_size{};
+    };
+
+  }
+
+#endif
@@ -34,6 +34,7 @@
 
 #include "dab/types/parse_status.h"
 #include "dab/types/queue.h"
+#include "dab/types/symbol_pool.h"
 
 #include <complex>
 #include <cstdint>
@@ -89,6 +90,16 @@ namespace dab
    */
   using symbol_queue_t = internal::queue<std::vector<float>>;
 
+  /**
+   * @brief The type of a queue for transporting symbols held in a dab::internal::symbol_pool
+   *
+   * The queue carries handles to the buffers of the pool, so that the queue moves them with its
+   * trivially-copyable paths and the soft bits themselves are never copied.
+   *
+   * @since  1.1.0
+   */
+  using pooled_symbol_queue_t = internal::queue<symbol_buffer_t>;
+
   namespace internal
     {
 
@@ -49,7 +49,8 @@ namespace dab
     invalid_address, ///< The address did not match the expected one
     incomplete, ///< There is still data missing
     segment_lost, ///< At least one segment was missing
-    ok ///< Everything went well
+    ok, ///< Everything went well
+    unknown_context ///< The header context was not known to the parser
     };
 
   }
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_POOL_ALLOCATOR
+#define DABCOMMON_TYPES_POOL_ALLOCATOR
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace pool
+      {
+
+      /**
+       * @internal
+       * @brief The largest request served from the pool, larger ones go straight to the system allocator
+       *
+       * @since  1.1.0
+       */
+      std::size_t constexpr kLargestBlock{std::size_t{1} << 16};
+
+      /**
+       * @internal
+       * @brief Allocate a block of at least the given size
+       *
+       * Requests are rounded up to a power of two size class. Every thread keeps a cache of free blocks per
+       * class, refilled in batches from a shared depot, so that a block freed by one thread is reused by
+       * another without going back to the system allocator.
+       *
+       * @since  1.1.0
+       */
+      void * allocate(std::size_t size);
+
+      /**
+       * @internal
+       * @brief Return a block obtained from #allocate with the same size
+       *
+       * @since  1.1.0
+       */
+      void deallocate(void * block, std::size_t size);
+
+      /**
+       * @internal
+       * @brief The number of blocks the pool requested from the system allocator so far
+       *
+       * Once the pool has warmed up, this number stays constant as long as the workload does not grow.
+       *
+       * @since  1.1.0
+       */
+      std::uint64_t system_allocations();
+
+      }
+
+    /**
+     * @internal
+     * @brief A stateless allocator drawing from the size class pool
+     *
+     * @tparam ValueType The type of the objects to allocate
+     *
+     * @since  1.1.0
+     */
+    template<typename ValueType>
+    struct pool_allocator
+      {
+      using value_type = ValueType;
+
+      pool_allocator() = default;
+
+      template<typename OtherType>
+      pool_allocator(pool_allocator<OtherType> const &)
+        {
+        }
+
+      value_type * allocate(std::size_t count)
+        {
+        return static_cast<value_type *>(pool::allocate(count * sizeof(value_type)));
+        }
+
+      void deallocate(value_type * block, std::size_t count)
+        {
+        pool::deallocate(block, count * sizeof(value_type));
+        }
+      };
+
+    template<typename LeftType, typename RightType>
+    bool operator==(pool_allocator<LeftType> const &, pool_allocator<RightType> const &)
+      {
+      return true;
+      }
+
+    template<typename LeftType, typename RightType>
+    bool operator!=(pool_allocator<LeftType> const &, pool_allocator<RightType> const &)
+      {
+      return false;
+      }
+
+    /**
+     * @internal
+     * @brief A vector of bytes allocated from the size class pool
+     *
+     * Unlike dab::byte_vector_t, which stays a plain std::vector, this type is meant for buffers that are
+     * allocated and released once per datagram on the hot path.
+     *
+     * @since  1.1.0
+     */
+    using pooled_byte_vector_t = std::vector<std::uint8_t, pool_allocator<std::uint8_t>>;
+
+    }
+
+  }
+
+#endif
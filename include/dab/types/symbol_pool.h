@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_SYMBOL_POOL
+#define DABCOMMON_TYPES_SYMBOL_POOL
+
+#include "dab/types/bounded_queue.h"
+#include "dab/types/transmission_mode.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace dab
+  {
+
+  /**
+   * @brief A handle to a symbol buffer owned by a dab::internal::symbol_pool
+   *
+   * The handle is trivially copyable, so that passing it through a pooled_symbol_queue_t moves a pointer and an
+   * index instead of the soft bits. Whoever holds the handle owns the buffer until it is released to its pool.
+   *
+   * @since  1.1.0
+   */
+  struct symbol_buffer_t
+    {
+    float * data;
+    std::uint32_t index;
+    };
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief A bounded pool of fixed size symbol buffers
+     *
+     * All buffers are carved from a single allocation made at construction, each holding the
+     * transmission_mode::symbol_bits soft bits of one OFDM symbol. The free buffers are kept in a lock-free
+     * bounded_queue, so that any thread may acquire or release a buffer. The pool never grows, an exhausted
+     * pool is reported to the caller instead.
+     *
+     * @since  1.1.0
+     */
+    struct symbol_pool
+      {
+      /**
+       * @brief Construct a pool of the given number of buffers for symbols of the given transmission mode
+       *
+       * @throws std::invalid_argument if the number of buffers is zero
+       */
+      symbol_pool(types::transmission_mode const & mode, std::size_t buffers);
+
+      symbol_pool(symbol_pool const &) = delete;
+      symbol_pool & operator=(symbol_pool const &) = delete;
+
+      /**
+       * @brief Try to acquire a free buffer
+       *
+       * The contents of the buffer are those left by its previous owner.
+       *
+       * @return false if all buffers are in use
+       */
+      bool try_acquire(symbol_buffer_t & buffer);
+
+      /**
+       * @brief Return a buffer obtained from #try_acquire to the pool
+       *
+       * @throws std::invalid_argument if the buffer does not belong to this pool or was already released
+       */
+      void release(symbol_buffer_t buffer);
+
+      /**
+       * @brief Get the number of floats in each buffer
+       */
+      std::size_t symbol_size() const;
+
+      /**
+       * @brief Get the number of buffers in the pool
+       */
+      std::size_t capacity() const;
+
+      /**
+       * @brief Get the approximate number of buffers currently available
+       */
+      std::size_t approximate_available() const;
+
+      private:
+        std::size_t const m_symbolSize;
+        std::size_t const m_capacity;
+        std::unique_ptr<float[]> const m_storage;
+        std::unique_ptr<std::atomic<bool>[]> const m_inUse;
+        bounded_queue<std::uint32_t> m_free;
+      };
+
+    }
+
+  }
+
+#endif
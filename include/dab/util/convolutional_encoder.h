@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_UTIL_CONVOLUTIONAL_ENCODER
+#define DABIP_UTIL_CONVOLUTIONAL_ENCODER
+
+#include <dab/types/transmission_mode.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @brief A run of blocks punctured with the same vector.
+     *
+     * A block consists of 32 input bits, which the mother code turns into four 32 bit sub-blocks.
+     *
+     * @since 1.1.0
+     **/
+    struct puncturing_run
+      {
+      std::size_t blocks; ///< The number of consecutive blocks
+      std::uint8_t vector; ///< The index of the puncturing vector PI_1 to PI_24
+      };
+
+    using puncturing_profile_t = std::vector<puncturing_run>;
+
+    /**
+     * @brief The puncturing of an EEP protected sub-channel according to ETSI EN 300 401 clause 11.3.2.
+     * @param bitrate The capacity of the sub-channel in kbit/s.
+     * @param protection The sub-channel type and protection level (TPL) as carried in the STC of ETI.
+     * @throws std::invalid_argument if the protection is not EEP or the bitrate does not suit its option.
+     *
+     * @since 1.1.0
+     **/
+    puncturing_profile_t eep_profile(std::uint16_t bitrate, std::uint8_t protection);
+
+    /**
+     * @brief The puncturing of the FIBs of a CIF according to ETSI EN 300 401 clause 11.2.
+     *
+     * @since 1.1.0
+     **/
+    puncturing_profile_t fic_profile(types::transmission_mode const & mode);
+
+    /**
+     * @brief The number of bits a profile leaves of the mother code, including the punctured tail.
+     *
+     * @since 1.1.0
+     **/
+    std::size_t punctured_bits(puncturing_profile_t const & profile);
+
+    /**
+     * @brief A table driven encoder for the rate 1/4, constraint length 7 DAB mother code and its puncturing.
+     *
+     * Each input byte is encoded by a single lookup in a table shared by all encoders, indexed by the
+     * encoder state and the byte, yielding its 32 bit sub-block of the mother code. The sub-block is then
+     * punctured a byte at a time through tables built for the vectors of the profile. Every call encodes one
+     * logical frame or CIF, starting from the all zero state and terminated by six tail bits.
+     *
+     * @since 1.1.0
+     **/
+    struct convolutional_encoder
+      {
+      explicit convolutional_encoder(puncturing_profile_t const & profile);
+
+      /**
+       * @brief The number of bytes encoded per call.
+       */
+      std::size_t input_size() const;
+
+      /**
+       * @brief The number of punctured bytes produced per call, 8 per capacity unit for a sub-channel and
+       * transmission_mode::punctured_codeword_size / 8 for the FIC.
+       */
+      std::size_t output_size() const;
+
+      /**
+       * @brief Encodes #input_size bytes into #output_size bytes, most significant bit first.
+       */
+      void encode(std::uint8_t const * input, std::uint8_t * output) const;
+
+      private:
+      struct puncturer
+        {
+        std::array<std::array<std::uint8_t, 256>, 4> bits;
+        std::array<std::uint8_t, 4> counts;
+        };
+
+      struct run
+        {
+        std::size_t bytes;
+        std::size_t puncturer;
+        };
+
+      std::size_t add_puncturer(std::uint32_t vector);
+
+      std::vector<puncturer> m_puncturers{};
+      std::vector<run> m_runs{};
+      std::size_t m_tail_puncturer{};
+      std::size_t m_input_size{};
+      std::size_t m_output_size{};
+      };
+
+    }
+
+  }
+
+#endif
@@ -34,6 +34,7 @@
 
 #include <dab/types/common_types.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -48,6 +49,15 @@ namespace dab
      * @returns CRC16 CCITT of input.
      **/
     byte_vector_t genCRC16(byte_vector_t const & input);
+
+    /**
+     * @brief Feeds data into a running CRC16 CCITT, starting from 0xFFFF.
+     *
+     * The CRC of a sequence of ranges is the complement of the state after feeding all of them.
+     *
+     * @since 1.1.0
+     **/
+    std::uint16_t updateCRC16(std::uint16_t state, std::uint8_t const * data, std::size_t length);
     }
   }
 
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_UTIL_ENERGY_DISPERSAL
+#define DABIP_UTIL_ENERGY_DISPERSAL
+
+#include <dab/types/common_types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @brief The energy dispersal of a sub-channel according to ETSI EN 300 401 clause 10.2.
+     *
+     * The PRBS generated by x^9 + x^5 + 1, starting from all ones, is added modulo 2 to the bits of each
+     * logical frame. The sequence for the size of the sub-channel is precomputed once and then XORed over
+     * every frame, using AVX2 where the processor supports it and 64 bit words otherwise. Since the
+     * addition is its own inverse, the same operation also undoes the dispersal.
+     *
+     * @since 1.1.0
+     **/
+    struct energy_dispersal
+      {
+      /**
+       * @param length The number of bytes in a logical frame of the sub-channel.
+       */
+      explicit energy_dispersal(std::size_t length);
+
+      /**
+       * @brief Scrambles or descrambles a logical frame in place.
+       * @param data The #size bytes of the logical frame.
+       */
+      void apply(std::uint8_t * data) const;
+
+      /**
+       * @brief The number of bytes in a logical frame.
+       */
+      std::size_t size() const;
+
+      private:
+      using kernel_t = void (*)(std::uint8_t *, std::uint8_t const *, std::size_t);
+
+      byte_vector_t m_sequence;
+      kernel_t m_kernel;
+      };
+
+    }
+
+  }
+
+#endif
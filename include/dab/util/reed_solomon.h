@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_UTIL_REED_SOLOMON
+#define DABIP_UTIL_REED_SOLOMON
+
+#include <dab/types/common_types.h>
+
+#include <array>
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @brief A systematic RS(255, 207) encoder over GF(2^8) as used for EDI PFT protection.
+     *
+     * The field is generated by x^8 + x^4 + x^3 + x^2 + 1 and the roots of the generator polynomial are
+     * alpha^0 to alpha^47. Shorter chunks are zero padded at the end before computing the parity.
+     *
+     * @since 1.1.0
+     **/
+    struct reed_solomon_encoder
+      {
+      static std::size_t constexpr kDataLength {207};
+      static std::size_t constexpr kParityLength {48};
+
+      reed_solomon_encoder();
+
+      /**
+       * @brief Calculates the parity bytes for a chunk of at most kDataLength bytes.
+       * @param[out] parity The kParityLength parity bytes of the chunk.
+       */
+      void encode(std::uint8_t const * data, std::size_t length, std::uint8_t * parity) const;
+
+      private:
+      std::uint8_t multiply(std::uint8_t left, std::uint8_t right) const;
+
+      std::array<std::uint8_t, 512> m_exp {};
+      std::array<std::uint8_t, 256> m_log {};
+      std::array<std::uint8_t, kParityLength + 1> m_generator {};
+      };
+
+    }
+
+  }
+
+#endif
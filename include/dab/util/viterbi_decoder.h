@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABIP_UTIL_VITERBI_DECODER
+#define DABIP_UTIL_VITERBI_DECODER
+
+#include <dab/util/convolutional_encoder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @brief A soft decision Viterbi decoder for the punctured DAB mother code.
+     *
+     * The soft bits of a logical frame or CIF are quantized and depunctured into the 4 soft bits per input
+     * bit of the mother code, with erasures where bits were punctured. The 64 path metrics are 16 bit
+     * integers updated with saturating SSE2 butterflies, or AVX2 ones where the processor supports them,
+     * and renormalized every step. The decisions of the whole frame are kept, and traced back from the
+     * zero state the tail bits return the encoder to.
+     *
+     * A decoder holds the buffers of a single frame, so sub-channels are decoded in parallel by giving each
+     * thread decoders of its own.
+     *
+     * @since 1.1.0
+     **/
+    struct viterbi_decoder
+      {
+      explicit viterbi_decoder(puncturing_profile_t const & profile);
+
+      /**
+       * @brief The number of soft bits decoded per call.
+       */
+      std::size_t input_size() const;
+
+      /**
+       * @brief The number of bytes produced per call.
+       */
+      std::size_t output_size() const;
+
+      /**
+       * @brief Decodes a frame.
+       * @param soft The #input_size soft bits, positive for 0 and negative for 1, with a nominal magnitude of
+       * 1 for a reliable bit. Magnitudes beyond 4 are clipped.
+       * @param[out] output The #output_size decoded bytes, most significant bit first.
+       */
+      void decode(float const * soft, std::uint8_t * output);
+
+      private:
+      using kernel_t = void (*)(std::int16_t const *, std::size_t, std::uint64_t *);
+
+      std::vector<std::uint32_t> m_positions{};
+      std::vector<std::int16_t> m_soft;
+      std::vector<std::uint64_t> m_decisions;
+      std::size_t m_output_size;
+      kernel_t m_kernel;
+      };
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_CAPTURE_INGEST
+#define INJECTOR_CAPTURE_INGEST
+
+#include "injector/dispatch.h"
+#include "injector/service.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * Locate the IPv4 datagram inside a captured frame
+   *
+   * Ethernet (including VLAN tags), Linux cooked, BSD loopback and raw IP captures are supported. Trailing
+   * link layer padding is not part of the datagram.
+   *
+   * @param link_type The pcap link type of the capture
+   * @param frame The captured frame
+   * @param captured The number of bytes captured
+   * @param offset Set to the offset of the datagram inside the frame
+   * @param length Set to the total length of the datagram once its IPv4 header was found, even if the rest of the
+   *               datagram was not captured
+   * @return false if the frame does not carry a complete IPv4 datagram
+   */
+  bool find_ip_datagram(int link_type, std::uint8_t const * frame, std::size_t captured, std::size_t & offset, std::size_t & length);
+
+  /**
+   * @since 1.1.0
+   *
+   * Capture the IP datagrams of services from network interfaces
+   *
+   * Every service with a capture interface gets a thread of its own, capturing the datagrams matching its BPF
+   * filter in immediate mode through a large kernel buffer. The datagrams are taken from the pcap buffer as
+   * they are and packaged without ever being parsed into libtins PDUs. Datagrams longer than a data group can
+   * carry are dropped and counted as oversized.
+   */
+  struct capture_ingest
+    {
+    /**
+     * @param directory The directory to look up the services in
+     * @param dispatcher The dispatcher to hand captured datagrams to
+     */
+    capture_ingest(service_directory const & directory, dispatcher & dispatcher);
+
+    ~capture_ingest();
+
+    capture_ingest(capture_ingest const &) = delete;
+    capture_ingest & operator=(capture_ingest const &) = delete;
+
+    /**
+     * Start and stop captures to match the current service table
+     *
+     * @note This call waits for stopped captures to finish, so it should not be called on the hot path
+     */
+    void update();
+
+    private:
+      struct capture;
+
+      void run(capture & target);
+
+      service_directory const & m_directory;
+      dispatcher & m_dispatcher;
+      std::map<std::uint16_t, std::unique_ptr<capture>> m_captures;
+    };
+
+  }
+
+#endif
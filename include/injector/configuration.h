@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_CONFIGURATION
+#define INJECTOR_CONFIGURATION
+
+#include "injector/edi_output.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * The configuration of a single service
+   */
+  struct service_configuration_t
+    {
+    /**
+     * The name of the service, as used in the [service.<name>] section
+     */
+    std::string name{"default"};
+
+    /**
+     * The UDP port to receive the data of the service on
+     */
+    std::uint16_t port{4321};
+
+    /**
+     * The multicast group to join for receiving the data of the service, empty for unicast
+     */
+    std::string group{};
+
+    /**
+     * The address of the local interface to join the multicast group on, empty for the default
+     */
+    std::string interface{};
+
+    /**
+     * The endpoint to accept length-prefixed streams on, either "address:port" or "unix:/path", empty to disable
+     */
+    std::string stream{};
+
+    /**
+     * The network interface to capture the IP datagrams of the service on, empty to disable
+     */
+    std::string capture{};
+
+    /**
+     * The BPF filter selecting the datagrams to capture
+     */
+    std::string capture_filter{"ip"};
+
+    /**
+     * The size of the kernel buffer holding captured frames in bytes
+     */
+    std::size_t capture_buffer{64 << 20};
+
+    /**
+     * The DAB packet address for the packets of the service
+     */
+    std::uint16_t packet_address{1000};
+
+    /**
+     * The IP destination address of the packed data
+     */
+    std::string destination_address{"10.0.0.1"};
+
+    /**
+     * The UDP destination port of the packed data
+     */
+    std::uint16_t destination_port{4242};
+
+    /**
+     * The IP source address of the packed data
+     */
+    std::string source_address{"10.0.0.2"};
+
+    /**
+     * The UDP source port of the packed data
+     */
+    std::uint16_t source_port{1337};
+
+    /**
+     * Whether to replace the IP/UDP headers by a static header context ID
+     */
+    bool compress_headers{false};
+
+    /**
+     * The ID of the header context the receiver uses to restore the IP/UDP headers
+     */
+    std::uint8_t header_context_id{};
+
+    /**
+     * The zlib level to deflate payloads with, or -1 to send them uncompressed
+     */
+    int compression_level{-1};
+
+    /**
+     * The path of the preset dictionary shared with the receiver, if any
+     */
+    std::string compression_dictionary{};
+
+    /**
+     * The maximum time a received datagram may wait for compression and packaging before it is considered
+     * stale and dropped. A value of zero disables expiry. A change takes effect on the running service, so
+     * it is not compared by operator==.
+     */
+    std::chrono::milliseconds time_to_live{0};
+    };
+
+  bool operator==(service_configuration_t const & lhs, service_configuration_t const & rhs);
+
+  bool operator!=(service_configuration_t const & lhs, service_configuration_t const & rhs);
+
+  /**
+   * @since 1.1.0
+   *
+   * The configuration of a single output
+   */
+  struct output_configuration_t
+    {
+    /**
+     * The name of the output, as used in the [output.<name>] section
+     */
+    std::string name{"default"};
+
+    /**
+     * The kind of output, either "fifo", "file", "udp", "shm", "edi" or "eti"
+     */
+    std::string type{"fifo"};
+
+    /**
+     * The path of the FIFO or file, or the name of the shared memory object, to write to
+     */
+    std::string path{"/tmp/dabdata"};
+
+    /**
+     * Whether a file or ETI output empties an existing file when it is first opened, it is appended to otherwise
+     *
+     * Reopening an output after an error always appends, so that a recording is never lost.
+     */
+    bool truncate{false};
+
+    /**
+     * The number of packets the shared-memory ring can hold
+     */
+    std::uint64_t slots{4096};
+
+    /**
+     * The receivers of the UDP and EDI outputs, as "host:port"
+     */
+    std::vector<std::string> destinations{};
+
+    /**
+     * The number of blocks of packets waiting for the output before further ones are dropped, a power of two
+     */
+    std::size_t queue_size{1024};
+
+    /**
+     * The parameters of the EDI output, whose sub-channel description, transmission mode and backlog the ETI
+     * output shares
+     */
+    edi_parameters_t edi{};
+    };
+
+  bool operator==(output_configuration_t const & lhs, output_configuration_t const & rhs);
+
+  bool operator!=(output_configuration_t const & lhs, output_configuration_t const & rhs);
+
+  /**
+   * @since 1.1.0
+   *
+   * The parameters of a capture replay
+   */
+  struct replay_parameters_t
+    {
+    /**
+     * The pcap file to replay, empty to disable
+     */
+    std::string file{};
+
+    /**
+     * The factor to speed up the original timing by, 0 to replay as fast as possible
+     */
+    double speed{1};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The configuration of the injector
+   */
+  struct configuration_t
+    {
+    /**
+     * The services to inject, each received on its own port
+     */
+    std::vector<service_configuration_t> services{};
+
+    /**
+     * The number of receiver threads, each with its own socket per unicast service
+     */
+    std::size_t receivers{1};
+
+    /**
+     * The way the receivers wait for datagrams, either "asio" or "uring"
+     */
+    std::string input_backend{"asio"};
+
+    /**
+     * The number of packager threads, each packaging the data of a fixed subset of the services
+     */
+    std::size_t packagers{1};
+
+    /**
+     * The number of compressor threads, each deflating the payloads of a fixed subset of the services
+     */
+    std::size_t compressors{1};
+
+    /**
+     * The number of datagrams each packager queue can hold, a power of two
+     */
+    std::size_t queue_size{4096};
+
+    /**
+     * The outputs to write the packet stream to, each fed by a writer thread of its own
+     */
+    std::vector<output_configuration_t> outputs{};
+
+    /**
+     * The capture to replay into the services before exiting
+     */
+    replay_parameters_t replay{};
+
+    /**
+     * The endpoint to serve metrics on, either "address:port" or "unix:/path", empty to disable
+     */
+    std::string metrics_endpoint{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * Read the configuration from an INI file
+   *
+   * The services are described by [service.<name>] sections. If there are none, the [packet], [source] and
+   * [destination] sections describe a single service. Likewise, the outputs are described by [output.<name>]
+   * sections, or by the [output] section if there are none.
+   *
+   * @throws std::runtime_error if the file cannot be parsed
+   * @throws std::invalid_argument if the configuration is invalid
+   */
+  configuration_t read_configuration(std::string const & file);
+
+  }
+
+#endif
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_DISPATCH
+#define INJECTOR_DISPATCH
+
+#include "injector/service.h"
+
+#include <dab/constants/header_compression_constants.h>
+#include <dab/constants/msc_data_group_constants.h>
+#include <dab/types/bounded_queue.h>
+#include <dab/types/buffer_chain.h>
+#include <dab/types/common_types.h>
+#include <dab/types/queue.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * The largest payload that still fits into an MSC data group once wrapped into an IP/UDP datagram
+   */
+  std::size_t constexpr kMaxPayloadSize{dab::internal::constants::kMaxDatagramSize -
+                                        dab::internal::constants::kIPv4HeaderSize -
+                                        dab::internal::constants::kUDPHeaderSize};
+
+  /**
+   * @since 1.1.0
+   *
+   * A received datagram waiting to be packaged
+   */
+  struct queued_datagram_t
+    {
+    /**
+     * The payload as received from the remote endpoint
+     */
+    dab::iobuf data{};
+
+    /**
+     * The point in time at which the payload was received
+     */
+    std::chrono::steady_clock::time_point ingest_time{};
+
+    /**
+     * The service the payload belongs to, kept alive until the payload is written even if the service is removed
+     */
+    std::shared_ptr<service_t> service{};
+
+    /**
+     * Whether the payload already is a complete IP datagram, which is packaged as it is
+     */
+    bool raw{false};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The queue transporting datagrams to a compressor thread
+   */
+  using datagram_queue_t = dab::internal::queue<queued_datagram_t>;
+
+  /**
+   * @since 1.1.0
+   *
+   * The callbacks of producers waiting for room in a queue
+   *
+   * Producers that must not drop register a callback instead of polling, and the consumer runs the callbacks
+   * once it took a datagram out. The consumer only takes the lock if a callback is actually registered.
+   */
+  struct room_waiters
+    {
+    /**
+     * Register a callback to be run once, on the consumer thread, after the consumer made room
+     *
+     * @note The consumer may have made room before the callback was registered, so check again afterwards
+     */
+    void add(std::function<void()> waiter);
+
+    /**
+     * Run the registered callbacks, called by the consumer after taking a datagram out
+     */
+    void notify();
+
+    private:
+      std::atomic<bool> m_waiting{};
+      std::mutex m_mutex{};
+      std::vector<std::function<void()>> m_waiters{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The bounded queue in front of a compressor thread
+   */
+  struct compression_queue
+    {
+    explicit compression_queue(std::size_t capacity);
+
+    /**
+     * Enqueue a datagram
+     *
+     * @return false if the queue is full, in which case the datagram is left untouched
+     */
+    bool try_enqueue(queued_datagram_t && datagram);
+
+    /**
+     * Dequeue the next datagram, waiting until one is available
+     */
+    void dequeue(queued_datagram_t & datagram);
+
+    /**
+     * Run the given callback once the queue has room
+     */
+    void when_room(std::function<void()> waiter);
+
+    std::size_t approximate_size() const;
+
+    private:
+      std::size_t const m_capacity;
+      datagram_queue_t m_queue{};
+      room_waiters m_waiters{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The lock-free queue in front of a packager thread
+   *
+   * Any number of threads may enqueue, only the packager dequeues. An idle packager spins for a while and
+   * then parks on a futex, which producers only touch if it is actually parked. Likewise, producers that must
+   * not drop park on a second futex while the queue is full, which the packager only touches if one does.
+   */
+  struct packager_queue
+    {
+    explicit packager_queue(std::size_t capacity);
+
+    /**
+     * Enqueue a datagram, waking up the packager if necessary
+     *
+     * @return false if the queue is full, in which case the datagram is left untouched
+     */
+    bool try_enqueue(queued_datagram_t && datagram);
+
+    /**
+     * Enqueue a datagram, waiting until there is room for it
+     */
+    void enqueue(queued_datagram_t && datagram);
+
+    /**
+     * Dequeue the next datagram, waiting until one is available
+     */
+    void dequeue(queued_datagram_t & datagram);
+
+    /**
+     * Run the given callback once the queue has room
+     */
+    void when_room(std::function<void()> waiter);
+
+    std::size_t approximate_size() const;
+
+    private:
+      void wake_packager();
+
+      dab::internal::bounded_queue<queued_datagram_t> m_queue;
+      std::atomic<std::uint32_t> m_parked{};
+      std::atomic<std::uint32_t> m_full{};
+      room_waiters m_waiters{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * Route received datagrams to the compressor or the packager threads
+   *
+   * All datagrams of a service go to the same compressor and packager thread, chosen by packet address, so that
+   * the compression and continuity state of a service is only ever touched by a single thread.
+   */
+  struct dispatcher
+    {
+    /**
+     * @param packagers The number of packager threads
+     * @param capacity The number of datagrams each queue can hold, a power of two
+     * @param compressors The number of compressor threads
+     */
+    dispatcher(std::size_t packagers, std::size_t capacity, std::size_t compressors = 1);
+
+    /**
+     * Hand a received datagram to the next stage of its service, dropping it if that stage is full
+     */
+    void dispatch(queued_datagram_t && datagram);
+
+    /**
+     * Hand a received datagram to the next stage of its service
+     *
+     * @return false if that stage is full, in which case the datagram is left untouched
+     */
+    bool try_dispatch(queued_datagram_t && datagram);
+
+    /**
+     * Hand a datagram to the packager of its service
+     *
+     * @return false if the packager is full, in which case the datagram is left untouched
+     */
+    bool try_package(queued_datagram_t && datagram);
+
+    /**
+     * Hand a datagram to the packager of its service, waiting until the packager has room for it
+     */
+    void package(queued_datagram_t && datagram);
+
+    /**
+     * Run the given callback once the next stage of a datagram has room, e.g. after try_dispatch failed
+     */
+    void when_room(queued_datagram_t const & datagram, std::function<void()> waiter);
+
+    /**
+     * The queue in front of the compressor thread of the given service
+     */
+    compression_queue & compressor_of(service_t const & service);
+
+    /**
+     * The queues in front of the compressor threads
+     */
+    std::vector<std::unique_ptr<compression_queue>> const & compression_queues() const;
+
+    /**
+     * The queues in front of the packager threads
+     */
+    std::vector<std::unique_ptr<packager_queue>> const & packager_queues() const;
+
+    private:
+      packager_queue & packager_of(service_t const & service);
+
+      std::vector<std::unique_ptr<compression_queue>> m_compression_queues{};
+      std::vector<std::unique_ptr<packager_queue>> m_packager_queues{};
+    };
+
+  }
+
+#endif
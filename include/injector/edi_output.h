@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_EDI_OUTPUT
+#define INJECTOR_EDI_OUTPUT
+
+#include "injector/metrics.h"
+#include "injector/output.h"
+#include "injector/subchannel_stream.h"
+
+#include <dab/edi/af_packet_generator.h>
+#include <dab/edi/pft_generator.h>
+#include <dab/types/common_types.h>
+
+#include <sys/socket.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * The parameters of an EDI output
+   */
+  struct edi_parameters_t
+    {
+    /**
+     * The receivers to send the frames to, as "host:port"
+     */
+    std::vector<std::string> destinations{};
+
+    /**
+     * The capacity of the packet mode sub-channel in kbit/s, a multiple of 8
+     */
+    std::uint16_t bitrate{8};
+
+    /**
+     * The description of the sub-channel carrying the packets
+     */
+    dab::est_parameters stream{1, 0, 0, 0};
+
+    /**
+     * The DAB transmission mode of the ensemble, 1 to 4
+     */
+    std::uint8_t mode{1};
+
+    /**
+     * The number of frames of packets waiting to be sent before further blocks are dropped
+     */
+    std::size_t backlog{42};
+
+    /**
+     * Whether to fragment the AF packets using PFT
+     */
+    bool pft{false};
+
+    /**
+     * The number of lost PFT fragments the receiver can recover from, 0 disables FEC
+     */
+    std::uint8_t fec{0};
+
+    /**
+     * The maximum payload size of a single PFT fragment
+     */
+    std::size_t fragment_size{1400};
+
+    /**
+     * The current difference between TAI and UTC in seconds
+     */
+    std::uint8_t tai_offset{37};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * An output sending the packet stream as EDI AF packets via UDP
+   *
+   * Every 24ms, the next bitrate * 3 bytes of the packet stream are wrapped into a timestamped AF packet,
+   * padded with padding packets if not enough data is available. The AF packet is then optionally split
+   * into PFT fragments and sent to all destinations with a single sendmmsg call.
+   */
+  struct edi_output : output
+    {
+    /**
+     * @param parameters The parameters of the output
+     * @param dropped The counter to account the blocks dropped from a full backlog to
+     */
+    edi_output(edi_parameters_t const & parameters, counter & dropped);
+
+    ~edi_output();
+
+    edi_output(edi_output const &) = delete;
+    edi_output & operator=(edi_output const &) = delete;
+
+    /**
+     * Queue a block of complete DAB packets for the next frames
+     */
+    void write(dab::buffer_chain const & packets) override;
+
+    private:
+      void run();
+
+      dab::byte_vector_t take_frame();
+
+      dab::byte_vector_t build_af_packet(dab::byte_vector_t const & frame);
+
+      void send(std::vector<dab::byte_vector_t> const & datagrams);
+
+      edi_parameters_t const m_parameters;
+      std::size_t const m_frame_size;
+      std::vector<sockaddr_storage> m_destinations{};
+      std::vector<socklen_t> m_destination_lengths{};
+      int m_socket{-1};
+
+      dab::af_packet_generator m_af_generator{};
+      std::unique_ptr<dab::pft_generator> m_pft_generator{};
+      std::uint16_t m_frame_count{};
+
+      subchannel_stream m_stream;
+
+      std::atomic<bool> m_running{true};
+      std::thread m_thread{};
+    };
+
+  }
+
+#endif
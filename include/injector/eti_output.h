@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_ETI_OUTPUT
+#define INJECTOR_ETI_OUTPUT
+
+#include "injector/edi_output.h"
+#include "injector/metrics.h"
+#include "injector/output.h"
+#include "injector/subchannel_stream.h"
+
+#include <dab/eti/eti_frame_generator.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * An output writing the packet stream as a packet mode sub-channel of ETI(NI) frames
+   *
+   * Every 24ms, the next bitrate * 3 bytes of the packet stream are placed into the sub-channel of a
+   * preallocated frame, padded with padding packets if not enough data is available. The completed 6144
+   * byte frame is then written to the given file or FIFO.
+   */
+  struct eti_output : output
+    {
+    /**
+     * @param path The file or FIFO to write the frames to
+     * @param truncate Whether to empty an existing file instead of appending to it
+     * @param parameters The transmission mode, bitrate, description and backlog of the sub-channel
+     * @param dropped The counter to account the blocks dropped from a full backlog to
+     */
+    eti_output(std::string const & path, bool truncate, edi_parameters_t const & parameters, counter & dropped);
+
+    ~eti_output();
+
+    eti_output(eti_output const &) = delete;
+    eti_output & operator=(eti_output const &) = delete;
+
+    /**
+     * Queue a block of complete DAB packets for the next frames
+     */
+    void write(dab::buffer_chain const & packets) override;
+
+    private:
+      void run();
+
+      void write_frame(dab::byte_vector_t const & frame);
+
+      dab::eti_frame_generator m_generator;
+      int m_descriptor{-1};
+
+      subchannel_stream m_stream;
+
+      std::atomic<bool> m_running{true};
+      std::thread m_thread{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_FANOUT_OUTPUT
+#define INJECTOR_FANOUT_OUTPUT
+
+#include "injector/metrics.h"
+#include "injector/output.h"
+
+#include <dab/types/buffer_chain.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * A block of packets shared by all outputs it is written to
+   */
+  using shared_packets_t = std::shared_ptr<dab::buffer_chain const>;
+
+  /**
+   * @since 1.1.0
+   *
+   * Get the counter of the blocks of packets the output of the given name dropped
+   */
+  counter & output_dropped(std::string const & name);
+
+  /**
+   * @since 1.1.0
+   *
+   * Feed the same packet stream to several outputs
+   *
+   * Every output has a queue and a writer thread of its own, and the queues share the blocks of packets by
+   * reference. An output that is slow, blocked or failing only drops blocks from its own queue while the
+   * others carry on. A failed output is reopened once per second.
+   */
+  struct fanout_output
+    {
+    /**
+     * Open an output, called on the writer thread of the output
+     */
+    using factory_t = std::function<std::unique_ptr<output>()>;
+
+    fanout_output() = default;
+
+    fanout_output(fanout_output const &) = delete;
+    fanout_output & operator=(fanout_output const &) = delete;
+
+    /**
+     * Add an output and start its writer thread
+     *
+     * The writer thread opens the output itself, so that e.g. a FIFO nobody reads from yet only holds back
+     * its own output.
+     *
+     * @param name The name of the output in logs and metrics
+     * @param open The factory opening the output
+     * @param queue_size The number of blocks the queue of the output can hold, a power of two
+     */
+    void add(std::string const & name, factory_t open, std::size_t queue_size);
+
+    /**
+     * Queue a block of packets for every output, may be called from several threads at once
+     */
+    void write(shared_packets_t const & packets);
+
+    private:
+      struct sink;
+
+      std::vector<std::shared_ptr<sink>> m_sinks{};
+    };
+
+  }
+
+#endif
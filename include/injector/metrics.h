@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_METRICS
+#define INJECTOR_METRICS
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * The number of shards per metric, threads are assigned to shards round-robin
+   */
+  std::size_t constexpr kMetricShards{8};
+
+  /**
+   * @since 1.1.0
+   *
+   * Get the metric shard of the calling thread
+   */
+  std::size_t thread_shard();
+
+  /**
+   * @since 1.1.0
+   *
+   * A monotonically increasing counter
+   *
+   * Every thread updates its own cache line with a relaxed atomic add, so recording never contends
+   * with other threads. The shards are only summed up when the value is read.
+   */
+  struct counter
+    {
+    void add(std::uint64_t amount = 1)
+      {
+      m_shards[thread_shard()].value.fetch_add(amount, std::memory_order_relaxed);
+      }
+
+    std::uint64_t value() const;
+
+    private:
+      struct alignas(64) shard
+        {
+        std::atomic<std::uint64_t> value{};
+        };
+
+      std::array<shard, kMetricShards> m_shards{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * A log-linear histogram in the spirit of HdrHistogram
+   *
+   * Values below 16 get their own bucket, larger values are recorded with 4 significant bits, giving a
+   * relative error below 1/8 across the whole range. Like the counter, the histogram is sharded per
+   * thread.
+   */
+  struct histogram
+    {
+    static std::size_t constexpr kSubBucketBits{4};
+    static std::size_t constexpr kBuckets{256};
+
+    void record(std::uint64_t value)
+      {
+      auto & shard = m_shards[thread_shard()];
+      shard.buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+      shard.sum.fetch_add(value, std::memory_order_relaxed);
+      }
+
+    /**
+     * Get the number of values recorded with an upper bound of at most @p bound
+     */
+    std::uint64_t count_below(std::uint64_t bound) const;
+
+    std::uint64_t count() const;
+
+    std::uint64_t sum() const;
+
+    /**
+     * Get the upper bound of the bucket holding the given quantile, e.g. 0.99, of the recorded values
+     */
+    std::uint64_t quantile(double fraction) const;
+
+    /**
+     * Get the index of the bucket the given value is recorded in
+     */
+    static std::size_t bucket(std::uint64_t value);
+
+    /**
+     * Get the largest value recorded in the given bucket
+     */
+    static std::uint64_t upper_bound(std::size_t bucket);
+
+    private:
+      struct alignas(64) shard
+        {
+        std::array<std::atomic<std::uint64_t>, kBuckets> buckets{};
+        std::atomic<std::uint64_t> sum{};
+        };
+
+      std::array<shard, kMetricShards> m_shards{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The collection of all metrics exposed by the injector
+   *
+   * Metrics live as long as the registry. Registering a name and labels again returns the existing metric,
+   * so that a service that is removed and added back continues its series. The registry renders them in
+   * the Prometheus text exposition format.
+   */
+  struct metrics_registry
+    {
+    /**
+     * Register a counter
+     *
+     * @param name The metric name, e.g. "dab_injector_datagrams_received_total"
+     * @param help The description of the metric
+     * @param labels The rendered labels, e.g. "service=\"1000\""
+     */
+    counter & make_counter(std::string const & name, std::string const & help, std::string const & labels = "");
+
+    /**
+     * Register a histogram
+     */
+    histogram & make_histogram(std::string const & name, std::string const & help, std::string const & labels = "");
+
+    /**
+     * Register a gauge whose value is sampled when rendering, replacing the sampler of an existing one
+     */
+    void make_gauge(std::string const & name, std::string const & help, std::string const & labels, std::function<double()> sample);
+
+    /**
+     * Render all metrics in the Prometheus text exposition format
+     */
+    std::string render() const;
+
+    private:
+      struct entry;
+
+      entry * find(std::string const & name, std::string const & labels);
+
+      struct entry
+        {
+        std::string name;
+        std::string help;
+        std::string type;
+        std::string labels;
+        counter * counter_metric;
+        histogram * histogram_metric;
+        std::function<double()> sample;
+        };
+
+      std::mutex mutable m_mutex{};
+      std::deque<counter> m_counters{};
+      std::deque<histogram> m_histograms{};
+      std::deque<entry> m_entries{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The process wide metrics registry
+   */
+  metrics_registry & metrics();
+
+  }
+
+#endif
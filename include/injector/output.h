@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_OUTPUT
+#define INJECTOR_OUTPUT
+
+#include <dab/types/buffer_chain.h>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <string>
+#include <vector>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * The interface of the destinations the packaged DAB packets are written to
+   */
+  struct output
+    {
+    virtual ~output() = default;
+
+    /**
+     * Write a block of complete DAB packets
+     */
+    virtual void write(dab::buffer_chain const & packets) = 0;
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * An output writing the packets as a raw byte stream to a FIFO or file
+   *
+   * Every block is handed to the kernel with a single gather write, unless the FIFO accepts only part of it.
+   * An existing file is appended to unless it is explicitly truncated.
+   */
+  struct fifo_output : output
+    {
+    /**
+     * @param path The path of the FIFO or file to write to
+     * @param truncate Whether to empty an existing file instead of appending to it
+     */
+    fifo_output(std::string const & path, bool truncate);
+
+    ~fifo_output();
+
+    fifo_output(fifo_output const &) = delete;
+    fifo_output & operator=(fifo_output const &) = delete;
+
+    /**
+     * @throws std::system_error if the packets cannot be written
+     */
+    void write(dab::buffer_chain const & packets) override;
+
+    private:
+      int m_descriptor;
+      std::vector<iovec> m_vectors{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * An output sending every block of packets as a single UDP datagram to one or more receivers
+   *
+   * The datagrams are gathered straight from the packet buffers, without copying them.
+   */
+  struct udp_output : output
+    {
+    /**
+     * @param destinations The receivers to send the packets to, as "host:port"
+     */
+    explicit udp_output(std::vector<std::string> const & destinations);
+
+    ~udp_output();
+
+    udp_output(udp_output const &) = delete;
+    udp_output & operator=(udp_output const &) = delete;
+
+    /**
+     * @throws std::system_error if the packets cannot be sent
+     */
+    void write(dab::buffer_chain const & packets) override;
+
+    private:
+      std::vector<sockaddr_storage> m_destinations{};
+      std::vector<socklen_t> m_destination_lengths{};
+      int m_socket{-1};
+      std::vector<iovec> m_vectors{};
+      dab::byte_vector_t m_block{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * Resolve a "host:port" string to an IPv4 socket address
+   *
+   * @throws std::invalid_argument if the destination lacks a port or cannot be resolved
+   */
+  void resolve(std::string const & destination, sockaddr_storage & address, socklen_t & length);
+
+  }
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_PAYLOAD_COMPRESSOR
+#define INJECTOR_PAYLOAD_COMPRESSOR
+
+#include <dab/types/buffer_chain.h>
+
+#include <zlib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * Counters describing the work done by a payload compressor
+   */
+  struct compression_statistics_t
+    {
+    /**
+     * The number of payloads compressed
+     */
+    std::uint64_t payloads{};
+
+    /**
+     * The number of bytes before compression
+     */
+    std::uint64_t bytes_in{};
+
+    /**
+     * The number of bytes after compression
+     */
+    std::uint64_t bytes_out{};
+
+    /**
+     * The CPU time spent compressing
+     */
+    std::chrono::nanoseconds cpu_time{};
+
+    /**
+     * The ratio between the uncompressed and the compressed size
+     */
+    double ratio() const;
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * A reusable deflate context for the payloads of a single service
+   *
+   * The zlib stream is allocated once and reset between payloads, so compressing does not
+   * allocate beyond the output buffer. If a dictionary is given, it is installed as preset
+   * dictionary for every payload, which allows small payloads to refer to common strings.
+   * The receiver needs the same dictionary to inflate the payloads.
+   */
+  struct payload_compressor
+    {
+    /**
+     * @param level The zlib compression level in the range [0, 9]
+     * @param dictionary The preset dictionary, empty for none
+     */
+    payload_compressor(int level, std::string dictionary);
+
+    ~payload_compressor();
+
+    payload_compressor(payload_compressor const &) = delete;
+    payload_compressor & operator=(payload_compressor const &) = delete;
+
+    /**
+     * Compress a single payload into a self-contained zlib stream
+     */
+    dab::iobuf compress(dab::iobuf const & payload);
+
+    /**
+     * Get the counters of this compressor
+     */
+    compression_statistics_t const & statistics() const;
+
+    private:
+      z_stream m_stream{};
+      std::string const m_dictionary;
+      compression_statistics_t m_statistics{};
+    };
+
+  }
+
+#endif
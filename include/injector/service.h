@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_SERVICE
+#define INJECTOR_SERVICE
+
+#include "injector/configuration.h"
+#include "injector/metrics.h"
+#include "injector/payload_compressor.h"
+
+#include <dab/header_compression/header_compressor.h>
+#include <dab/ip/udp_datagram_generator.h>
+#include <dab/msc_data_group/msc_data_group_generator.h>
+#include <dab/packet/packet_generator.h>
+#include <dab/types/buffer_chain.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * Metrics describing what happened to the data of a service
+   */
+  struct service_statistics_t
+    {
+    /**
+     * Register the metrics of the service described by the given configuration
+     */
+    explicit service_statistics_t(service_configuration_t const & config);
+
+    /**
+     * Account for a block of packets written to the output
+     */
+    void count_packets(dab::buffer_chain const & written);
+
+    std::string const labels;
+    counter & datagrams_received;
+    counter & bytes_received;
+    counter & datagrams_sent;
+    counter & bytes_sent;
+    counter & padding_bytes;
+    counter & expired;
+    counter & overflow;
+    counter & oversized;
+    counter & stalls;
+    histogram & latency;
+    std::array<counter *, 4> packets{};
+    std::array<counter *, 3> encode_time{};
+
+    /**
+     * The number of datagrams dropped since the last report
+     */
+    std::atomic<std::uint64_t> expired_unreported{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The runtime state of a service
+   *
+   * The generators carry the continuity state of the service, which is why a service is kept alive across
+   * configuration reloads that do not change it. The generators are only used by the packager thread, the
+   * payload compressor only by the compressor thread the service is assigned to. The time to live is taken from the latest configuration,
+   * even for a service kept alive across a reload.
+   */
+  struct service_t
+    {
+    /**
+     * Create the state of a service, reading its compression dictionary if any
+     *
+     * @throws std::invalid_argument if the source or destination address is not an IPv4 address
+     * @throws std::runtime_error if the compression dictionary cannot be read
+     */
+    explicit service_t(service_configuration_t const & config);
+
+    service_t(service_t const &) = delete;
+    service_t & operator=(service_t const &) = delete;
+
+    service_configuration_t const config;
+    dab::udp_datagram_generator datagrams;
+    dab::msc_data_group_generator grouper{};
+    dab::packet_generator packer;
+    dab::header_compressor header_compressor;
+    std::unique_ptr<payload_compressor> compressor{};
+    service_statistics_t statistics;
+    std::atomic<std::chrono::milliseconds::rep> time_to_live;
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * An immutable snapshot of the configuration and the services
+   */
+  struct service_table_t
+    {
+    configuration_t config;
+
+    /**
+     * The services, keyed by the port they are received on
+     */
+    std::map<std::uint16_t, std::shared_ptr<service_t>> services;
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * Build the service table for a new configuration
+   *
+   * Services whose configuration did not change are taken over from the previous table including their
+   * state, all others are created anew. This does all the expensive work, so it should not be called on
+   * the hot path.
+   *
+   * @param config The new configuration
+   * @param previous The table currently in use, if any
+   */
+  std::shared_ptr<service_table_t const> make_service_table(configuration_t config, service_table_t const * previous = nullptr);
+
+  /**
+   * @since 1.1.0
+   *
+   * The current service table, replaced as a whole on reload
+   *
+   * Readers take a reference to the current table and keep using it for as long as they need, the table
+   * and its services are destroyed once the last reader drops its reference.
+   */
+  struct service_directory
+    {
+    explicit service_directory(std::shared_ptr<service_table_t const> table);
+
+    /**
+     * Get the current table
+     */
+    std::shared_ptr<service_table_t const> current() const;
+
+    /**
+     * Replace the current table
+     */
+    void publish(std::shared_ptr<service_table_t const> table);
+
+    /**
+     * Get the number of tables published so far, which is cheap enough to check for every datagram
+     */
+    std::uint64_t generation() const;
+
+    private:
+      std::shared_ptr<service_table_t const> m_current;
+      std::atomic<std::uint64_t> m_generation{};
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * The table of a directory as seen by a single receiving thread
+   *
+   * Loading the current table from the directory serializes all threads doing so on a shared reference count.
+   * The cache keeps its own reference instead and only reloads it once a new table was published.
+   */
+  struct service_table_cache
+    {
+    explicit service_table_cache(service_directory const & directory);
+
+    /**
+     * Get the current table, refreshing the cached one if it was replaced
+     */
+    service_table_t const & current();
+
+    private:
+      service_directory const & m_directory;
+      std::uint64_t m_generation;
+      std::shared_ptr<service_table_t const> m_table;
+    };
+
+  }
+
+#endif
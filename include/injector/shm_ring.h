@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_SHM_RING
+#define INJECTOR_SHM_RING
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file
+ *
+ * @brief The memory layout of the shared-memory packet ring
+ *
+ * The ring consists of a header followed by a power of two number of slots. Each slot carries a single
+ * DAB packet and the sequence number it was published with. Sequence numbers start at 1 and the packet
+ * with sequence number n lives in slot (n - 1) % slot_count. The single producer never waits for
+ * readers, instead readers detect being overrun by comparing sequence numbers.
+ *
+ * A slot is published by first clearing its sequence number, then writing the packet, and finally
+ * storing the new sequence number with release semantics. The header's write sequence is advanced
+ * after each slot. Once a batch of packets is published, the futex word is incremented and, if there
+ * are waiting readers, they are woken up.
+ *
+ * A restarted producer keeps using a ring of the same layout, continuing its sequence numbers. If the
+ * layout changed, the old ring is left mapped for the readers still attached to it, its generation is
+ * incremented and a new ring takes its name. Readers seeing the generation change attach to the new ring.
+ *
+ * @since 1.1.0
+ */
+
+namespace injector
+  {
+
+  namespace shm
+    {
+
+    std::uint32_t constexpr kRingMagic{0x44414252};
+    std::uint32_t constexpr kRingVersion{2};
+    std::size_t constexpr kSlotPayloadSize{96};
+
+    /**
+     * @since 1.1.0
+     *
+     * The header at the start of the shared memory region
+     */
+    struct alignas(64) ring_header
+      {
+      std::atomic<std::uint32_t> magic;
+      std::uint32_t version;
+      std::uint64_t slot_count;
+
+      /**
+       * Incremented when the ring is replaced by one of a different layout
+       */
+      std::atomic<std::uint32_t> generation;
+
+      /**
+       * The sequence number of the last published packet
+       */
+      alignas(64) std::atomic<std::uint64_t> write_sequence;
+
+      /**
+       * The word readers wait on, incremented for every published batch
+       */
+      std::atomic<std::uint32_t> futex_word;
+
+      /**
+       * The number of readers currently waiting on the futex word
+       */
+      std::atomic<std::uint32_t> waiters;
+      };
+
+    /**
+     * @since 1.1.0
+     *
+     * A single packet in the ring
+     */
+    struct alignas(64) ring_slot
+      {
+      std::atomic<std::uint64_t> sequence;
+      std::uint32_t length;
+      std::uint8_t data[kSlotPayloadSize];
+      };
+
+    static_assert(sizeof(ring_slot) == 128, "unexpected ring slot layout");
+
+    /**
+     * Get the size in bytes of a ring with the given number of slots
+     */
+    inline std::size_t ring_size(std::uint64_t slot_count)
+      {
+      return sizeof(ring_header) + slot_count * sizeof(ring_slot);
+      }
+
+    /**
+     * Get the slots following the header of a ring
+     */
+    inline ring_slot * ring_slots(ring_header * header)
+      {
+      return reinterpret_cast<ring_slot *>(header + 1);
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_SHM_RING_READER
+#define INJECTOR_SHM_RING_READER
+
+#include "injector/shm_ring.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * A view of a single packet inside the shared-memory ring
+   *
+   * The view points directly into the shared memory. Since the producer never waits for readers, the
+   * packet may be overwritten while it is being processed. Use shm_ring_reader::valid after consuming
+   * the packet to make sure it was not.
+   */
+  struct packet_view
+    {
+    std::uint64_t sequence;
+    std::uint8_t const * data;
+    std::uint32_t length;
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * A zero-copy reader for the shared-memory packet ring
+   *
+   * @see injector/shm_ring.h for a description of the protocol
+   */
+  struct shm_ring_reader
+    {
+    /**
+     * Attach to the ring with the given name, starting at the next packet to be published
+     *
+     * @param name The POSIX shared memory object name, e.g. "/dabdata"
+     */
+    explicit shm_ring_reader(std::string const & name);
+
+    ~shm_ring_reader();
+
+    shm_ring_reader(shm_ring_reader const &) = delete;
+    shm_ring_reader & operator=(shm_ring_reader const &) = delete;
+
+    /**
+     * Get the next packet, if one has been published
+     *
+     * If the writer replaced the ring by one of a different layout, the reader attaches to the new ring first.
+     *
+     * @note This call never blocks
+     */
+    bool next(packet_view & view);
+
+    /**
+     * Check that the packet of a view has not been overwritten in the meantime
+     */
+    bool valid(packet_view const & view) const;
+
+    /**
+     * Wait until a new packet is published or the timeout expires
+     */
+    void wait(std::chrono::milliseconds timeout);
+
+    /**
+     * Get the number of packets that were overwritten before they could be read
+     */
+    std::uint64_t lost() const;
+
+    private:
+      void attach();
+      void resynchronize(std::uint64_t published);
+
+      std::string const m_name;
+      shm::ring_header * m_header{};
+      shm::ring_slot const * m_slots{};
+      std::size_t m_size{};
+      std::uint64_t m_mask{};
+      std::uint64_t m_next{};
+      std::uint64_t m_lost{};
+      std::uint32_t m_generation{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_SHM_RING_WRITER
+#define INJECTOR_SHM_RING_WRITER
+
+#include "injector/output.h"
+#include "injector/shm_ring.h"
+
+#include <cstdint>
+#include <string>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * An output publishing DAB packets into a shared-memory ring, e.g. /dev/shm/dabdata
+   *
+   * @see injector/shm_ring.h for a description of the protocol
+   */
+  struct shm_ring_writer : output
+    {
+    /**
+     * @param name The POSIX shared memory object name, e.g. "/dabdata"
+     * @param slot_count The number of packets the ring can hold, must be a power of two
+     */
+    shm_ring_writer(std::string const & name, std::uint64_t slot_count);
+
+    ~shm_ring_writer();
+
+    shm_ring_writer(shm_ring_writer const &) = delete;
+    shm_ring_writer & operator=(shm_ring_writer const &) = delete;
+
+    /**
+     * Publish a block of complete DAB packets and wake up waiting readers
+     */
+    void write(dab::buffer_chain const & packets) override;
+
+    private:
+      void publish(std::uint8_t const * packet, std::uint32_t length);
+
+      shm::ring_header * m_header{};
+      shm::ring_slot * m_slots{};
+      std::uint64_t m_mask{};
+      std::uint64_t m_sequence{};
+      dab::byte_vector_t m_block{};
+    };
+
+  }
+
+#endif
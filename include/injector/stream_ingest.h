@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_STREAM_INGEST
+#define INJECTOR_STREAM_INGEST
+
+#include "injector/dispatch.h"
+#include "injector/service.h"
+
+#include <boost/asio/io_service.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * Receive the data of services over TCP or UNIX domain stream sockets
+   *
+   * Every service with a stream endpoint accepts any number of clients. Each message is prefixed by its length
+   * as a 32 bit big endian integer, messages of length zero are ignored. Messages that would not fit into a data
+   * group after adding IP and UDP headers are skipped and counted as oversized.
+   *
+   * Unlike datagrams received via UDP, messages are never dropped when the next stage of their service is
+   * full. Instead, the session stops reading until the next stage signals room again, so that TCP flow control
+   * throttles the producer. An existing UNIX domain socket at the path of an endpoint is replaced, the endpoint
+   * is not opened if any other file is in the way.
+   */
+  struct stream_ingest
+    {
+    /**
+     * @param runLoop The ASIO io_service to accept and read on
+     * @param directory The directory to look up the services in
+     * @param dispatcher The dispatcher to hand received messages to
+     */
+    stream_ingest(boost::asio::io_service & runLoop, service_directory const & directory, dispatcher & dispatcher);
+
+    ~stream_ingest();
+
+    stream_ingest(stream_ingest const &) = delete;
+    stream_ingest & operator=(stream_ingest const &) = delete;
+
+    /**
+     * Open and close listeners to match the current service table, must be called on the run loop
+     */
+    void update();
+
+    struct listener;
+
+    private:
+      boost::asio::io_service & m_runLoop;
+      service_directory const & m_directory;
+      dispatcher & m_dispatcher;
+      std::map<std::uint16_t, std::shared_ptr<listener>> m_listeners{};
+    };
+
+  }
+
+#endif
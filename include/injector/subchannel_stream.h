@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_SUBCHANNEL_STREAM
+#define INJECTOR_SUBCHANNEL_STREAM
+
+#include "injector/metrics.h"
+
+#include <dab/types/common_types.h>
+#include <dab/types/buffer_chain.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * The continuous byte stream of a packet mode sub-channel
+   *
+   * Blocks of complete packets are queued as they arrive, and taken out again one logical frame at a time.
+   * Since the sub-channel is a continuous byte stream, packets may straddle frames. The backlog is bounded,
+   * so that input exceeding the bitrate of the sub-channel is dropped instead of delaying all further packets.
+   */
+  struct subchannel_stream
+    {
+    /**
+     * @param capacity The number of bytes the backlog can hold
+     * @param dropped The counter to account the dropped blocks to
+     */
+    subchannel_stream(std::size_t capacity, counter & dropped);
+
+    /**
+     * Queue a block of complete DAB packets for the next frames, dropping it if the backlog is full
+     */
+    void append(dab::buffer_chain const & packets);
+
+    /**
+     * Fill a frame with the next bytes of the stream, padding it with padding packets if not enough are queued
+     *
+     * @param frame The frame to fill
+     * @param size The size of the frame, a multiple of 24
+     */
+    void take(std::uint8_t * frame, std::size_t size);
+
+    private:
+      std::size_t const m_capacity;
+      counter & m_dropped;
+      dab::byte_vector_t m_padding_packet{};
+
+      std::mutex m_mutex{};
+      dab::byte_vector_t m_pending{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_TRACE
+#define INJECTOR_TRACE
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file
+ *
+ * @brief Low-overhead tracing of the pipeline stages
+ *
+ * Tracing is only compiled in if INJECTOR_TRACING is defined, e.g. by configuring with
+ * -DDATA_INJECTOR_TRACING=ON. Otherwise INJECTOR_TRACE_SCOPE expands to nothing.
+ *
+ * Every thread records into its own ring of fixed size, so recording is a couple of stores and a
+ * release increment. The rings can be dumped as Chrome trace JSON, viewable in chrome://tracing or
+ * Perfetto, while the pipeline keeps running. Records that are overwritten during a dump are skipped.
+ *
+ * @since 1.1.0
+ */
+
+namespace injector
+  {
+
+  namespace trace
+    {
+
+    /**
+     * @since 1.1.0
+     *
+     * The traced pipeline stages
+     */
+    enum struct event : std::uint16_t
+      {
+      receive, ///< Receiving a datagram and handing it to the next stage
+      compress, ///< Compressing a payload
+      serialize, ///< Building the IP datagram
+      data_group, ///< Building the MSC data group
+      packet, ///< Splitting the MSC data group into packets
+      output, ///< Writing the packets to the output
+      };
+
+    /**
+     * @since 1.1.0
+     *
+     * A single trace record
+     */
+    struct record
+      {
+      std::uint64_t start;
+      std::uint64_t duration;
+      std::uint32_t arg;
+      event id;
+      };
+
+    std::size_t constexpr kRingCapacity{1 << 14};
+
+    /**
+     * @since 1.1.0
+     *
+     * The records of a single thread
+     */
+    struct ring
+      {
+      std::array<record, kRingCapacity> records;
+      std::atomic<std::uint64_t> head;
+      std::uint32_t thread;
+      };
+
+    /**
+     * Get the current trace time in nanoseconds
+     */
+    std::uint64_t now();
+
+    /**
+     * Append a record to the ring of the calling thread
+     */
+    void emit(event id, std::uint64_t start, std::uint64_t duration, std::uint32_t arg);
+
+    /**
+     * @since 1.1.0
+     *
+     * Record the duration of the enclosing scope
+     */
+    struct scope
+      {
+      scope(event id, std::uint32_t arg)
+        : m_id{id},
+          m_arg{arg},
+          m_start{now()}
+        {
+        }
+
+      ~scope()
+        {
+        emit(m_id, m_start, now() - m_start, m_arg);
+        }
+
+      scope(scope const &) = delete;
+      scope & operator=(scope const &) = delete;
+
+      private:
+        event const m_id;
+        std::uint32_t const m_arg;
+        std::uint64_t const m_start;
+      };
+
+    /**
+     * Render the records of all threads as Chrome trace JSON
+     */
+    std::string dump_chrome_json();
+
+    /**
+     * Dump the trace to /tmp/data-injector-<pid>-<n>.json whenever the given signal is received
+     */
+    void dump_on_signal(int signal);
+
+    }
+
+  }
+
+#if defined(INJECTOR_TRACING)
+#define INJECTOR_TRACE_CONCAT_IMPL(left, right) left##right
+#define INJECTOR_TRACE_CONCAT(left, right) INJECTOR_TRACE_CONCAT_IMPL(left, right)
+#define INJECTOR_TRACE_SCOPE(id, arg) \
+  ::injector::trace::scope INJECTOR_TRACE_CONCAT(injector_trace_scope_, __LINE__){::injector::trace::event::id, std::uint32_t(arg)}
+#else
+#define INJECTOR_TRACE_SCOPE(id, arg)
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_UDP_RECEIVER
+#define INJECTOR_UDP_RECEIVER
+
+#include "injector/dispatch.h"
+#include "injector/service.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * Receive the data of all services via UDP
+   *
+   * Every service is received on its own port. Every received datagram is stamped with its time of arrival and
+   * handed to the dispatcher. Sockets are opened and closed by #update as services come and go.
+   *
+   * With several receivers, each one binds its own socket to the port of every unicast service using
+   * SO_REUSEPORT, and the kernel spreads the datagrams across them. Multicast datagrams are delivered to all
+   * sockets bound to the port though, so each multicast service is received by a single receiver only.
+   */
+  struct udp_receiver
+    {
+    virtual ~udp_receiver() = default;
+
+    /**
+     * Open and close sockets to match the current service table, may be called from any thread
+     */
+    virtual void update() = 0;
+
+    /**
+     * Receive until the process ends
+     */
+    virtual void run() = 0;
+    };
+
+  /**
+   * @since 1.1.0
+   *
+   * Check whether a receiver with the given index is responsible for a service
+   */
+  bool receives(service_configuration_t const & service, std::size_t index, std::size_t count);
+
+  /**
+   * @since 1.1.0
+   *
+   * Open a UDP socket for a service, joining its multicast group if it has one
+   *
+   * @param service The service to open the socket for
+   * @param shared Whether other receivers bind the same port
+   * @return The file descriptor of the bound socket
+   * @throws std::system_error if the socket cannot be set up
+   */
+  int open_udp_socket(service_configuration_t const & service, bool shared);
+
+  /**
+   * @since 1.1.0
+   *
+   * Create a receiver using the given backend
+   *
+   * @param backend Either "asio", or "uring" to use io_uring if the kernel supports it and asio otherwise
+   * @param index The index of the receiver
+   * @param count The total number of receivers
+   * @param directory The directory to look up the services in
+   * @param dispatcher The dispatcher to hand received datagrams to
+   * @throws std::invalid_argument if the backend is unknown
+   */
+  std::unique_ptr<udp_receiver> make_udp_receiver(std::string const & backend, std::size_t index, std::size_t count,
+                                                  service_directory const & directory, dispatcher & dispatcher);
+
+  }
+
+#endif
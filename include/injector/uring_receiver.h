@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INJECTOR_URING_RECEIVER
+#define INJECTOR_URING_RECEIVER
+
+#include "injector/udp_receiver.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace injector
+  {
+
+  /**
+   * @since 1.1.0
+   *
+   * Check whether the kernel supports everything the io_uring receiver needs
+   *
+   * The receiver relies on multishot receives from a provided buffer ring, which are available since Linux 6.0.
+   */
+  bool uring_available();
+
+  /**
+   * @since 1.1.0
+   *
+   * The number of io_uring_enter system calls made by all io_uring receivers so far
+   */
+  std::uint64_t uring_enter_calls();
+
+  /**
+   * @since 1.1.0
+   *
+   * A receiver submitting its receives to an io_uring
+   *
+   * Every socket has a single multishot receive armed, which keeps delivering datagrams into buffers taken from a
+   * ring registered with the kernel. A single io_uring_enter reaps every datagram that arrived in the meantime,
+   * so a busy receiver needs far fewer system calls per datagram than one going through epoll and recvmsg.
+   */
+  struct uring_receiver : udp_receiver
+    {
+    /**
+     * @param index The index of this receiver
+     * @param count The total number of receivers
+     * @param directory The directory to look up the services in
+     * @param dispatcher The dispatcher to hand received datagrams to
+     * @throws std::system_error if the io_uring cannot be set up
+     */
+    uring_receiver(std::size_t index, std::size_t count, service_directory const & directory, dispatcher & dispatcher);
+
+    ~uring_receiver();
+
+    uring_receiver(uring_receiver const &) = delete;
+    uring_receiver & operator=(uring_receiver const &) = delete;
+
+    void update() override;
+
+    void run() override;
+
+    private:
+      friend bool uring_available();
+
+      struct ring;
+      struct listener;
+
+      void synchronize();
+
+      void arm_wakeup();
+
+      void arm_receive(listener const & listener);
+
+      void complete(std::uint64_t id, std::int32_t result, std::uint32_t flags);
+
+      std::size_t const m_index;
+      std::size_t const m_count;
+      service_directory const & m_directory;
+      service_table_cache m_services;
+      dispatcher & m_dispatcher;
+      std::unique_ptr<ring> m_ring;
+      std::map<std::uint16_t, std::unique_ptr<listener>> m_listeners;
+      int m_wakeup;
+      std::uint64_t m_wakeup_value{};
+      std::uint64_t m_next_id{1};
+    };
+
+  }
+
+#endif
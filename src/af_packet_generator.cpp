@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/edi/af_packet_generator.h"
+#include "dab/constants/edi_constants.h"
+#include "dab/util/crc16.h"
+#include "dab/util/vector_helpers.h"
+
+#include <dab/types/common_types.h>
+
+namespace dab
+  {
+
+  using namespace internal;
+
+  namespace
+    {
+
+    void push_back_word(byte_vector_t & target, std::uint16_t value)
+      {
+      target.push_back(value >> 8);
+      target.push_back(value);
+      }
+
+    void push_back_long(byte_vector_t & target, std::uint32_t value)
+      {
+      push_back_word(target, value >> 16);
+      push_back_word(target, value);
+      }
+
+    }
+
+  byte_vector_t build_tag_item(std::string const & name, byte_vector_t const & value)
+    {
+    auto item = byte_vector_t{name.begin(), name.end()};
+    item.resize(4);
+    item.reserve(constants::kTagHeaderSize + value.size());
+    push_back_long(item, value.size() * 8); //Length in bits
+    item.insert(item.end(), value.begin(), value.end());
+    return item;
+    }
+
+  byte_vector_t build_ptr_tag()
+    {
+    auto value = byte_vector_t{'D', 'E', 'T', 'I'};
+    push_back_word(value, 0); //Major revision
+    push_back_word(value, 0); //Minor revision
+    return build_tag_item("*ptr", value);
+    }
+
+  byte_vector_t build_deti_tag(deti_parameters const & parameters)
+    {
+    auto value = byte_vector_t{};
+    value.reserve(14);
+
+    // ATSTF, FICF, RFUDF, FCTH and FCT:
+    auto const frame_count = parameters.frame_count % constants::kDLFCModulus;
+    push_back_word(value, 1 << 15 | (frame_count / 250) << 8 | frame_count % 250);
+
+    // STAT, MID, FP, RFA, RFU and MNSC:
+    value.push_back(0xFF);
+    value.push_back((parameters.mode_id & 0x03) << 6 | (frame_count & 0x07) << 3);
+    push_back_word(value, 0);
+
+    // UTCO, seconds and TSTA:
+    value.push_back(parameters.utc_offset);
+    push_back_long(value, parameters.seconds);
+    value.push_back(parameters.ticks >> 16);
+    push_back_word(value, parameters.ticks);
+    return build_tag_item("deti", value);
+    }
+
+  byte_vector_t build_est_tag(est_parameters const & parameters, byte_vector_t const & data)
+    {
+    auto value = byte_vector_t{};
+    value.reserve(3 + data.size());
+
+    // SCID, SAD, TPL and RFA:
+    value.push_back((parameters.subchannel_id & 0x3F) << 2 | (parameters.start_address >> 8 & 0x03));
+    value.push_back(parameters.start_address);
+    value.push_back((parameters.protection & 0x3F) << 2);
+    value.insert(value.end(), data.begin(), data.end());
+    return build_tag_item("est" + std::string(1, char(parameters.stream_index)), value);
+    }
+
+  byte_vector_t af_packet_generator::build(byte_vector_t const & tag_items)
+    {
+    auto packet = byte_vector_t{'A', 'F'};
+    packet.reserve(constants::kAFHeaderSize + tag_items.size() + 2);
+    push_back_long(packet, tag_items.size());
+    push_back_word(packet, m_sequence++);
+    packet.push_back(constants::kAFRevision);
+    packet.push_back(constants::kAFProtocolTypeTag);
+    packet.insert(packet.end(), tag_items.begin(), tag_items.end());
+    concat_vectors_inplace(packet, genCRC16(packet));
+    return packet;
+    }
+
+  }
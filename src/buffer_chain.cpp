@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/types/buffer_chain.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace dab
+  {
+
+  // The chain points into the buffers it holds, so moving them around must not move their bytes
+  static_assert(std::is_nothrow_move_constructible<iobuf>::value, "iobuf must be nothrow movable");
+
+  std::size_t constexpr iobuf::kDefaultHeadroom;
+  std::size_t constexpr iobuf::kDefaultTailroom;
+
+  iobuf::iobuf(std::size_t size, std::size_t headroom, std::size_t tailroom)
+    : m_storage(headroom + size + tailroom),
+      m_begin{headroom},
+      m_end{headroom + size}
+    {
+    }
+
+  void iobuf::resize(std::size_t size)
+    {
+    // The tailroom may still hold bytes from before a shrink, whether or not growing reallocates
+    if(size > this->size())
+      {
+      std::fill(end(), m_storage.data() + std::min(m_begin + size, m_storage.size()), 0);
+      }
+
+    if(m_begin + size > m_storage.size())
+      {
+      m_storage.resize(m_begin + size + kDefaultTailroom);
+      }
+    m_end = m_begin + size;
+    }
+
+  std::uint8_t * iobuf::prepend(std::size_t count)
+    {
+    if(count > m_begin)
+      {
+      auto const grown = count - m_begin + kDefaultHeadroom;
+      m_storage.insert(m_storage.begin(), grown, 0);
+      m_begin += grown;
+      m_end += grown;
+      }
+
+    m_begin -= count;
+    return data();
+    }
+
+  std::uint8_t * iobuf::append(std::size_t count)
+    {
+    auto const offset = size();
+    resize(offset + count);
+    return data() + offset;
+    }
+
+  iobuf const & buffer_chain::hold(iobuf && buffer)
+    {
+    m_buffers.push_back(std::move(buffer));
+    return m_buffers.back();
+    }
+
+  void buffer_chain::append(std::uint8_t const * data, std::size_t size)
+    {
+    if(!size)
+      {
+      return;
+      }
+
+    m_size += size;
+    if(!m_segments.empty() && m_segments.back().data + m_segments.back().size == data)
+      {
+      m_segments.back().size += size;
+      return;
+      }
+
+    m_segments.push_back(segment{data, size});
+    }
+
+  void buffer_chain::append(iobuf && buffer)
+    {
+    auto const & held = hold(std::move(buffer));
+    append(held.data(), held.size());
+    }
+
+  void buffer_chain::copy_to(byte_vector_t & target) const
+    {
+    target.clear();
+    target.reserve(m_size);
+    for(auto const & range : m_segments)
+      {
+      target.insert(target.end(), range.data, range.data + range.size);
+      }
+    }
+
+  }
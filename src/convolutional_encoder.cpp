@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/util/convolutional_encoder.h"
+#include "dab/constants/coding_constants.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace
+      {
+
+      std::size_t constexpr kBlockBytes {4};
+
+      /**
+       * The mother code sub-blocks of every byte in every state, indexed by state << 8 | byte
+       *
+       * The state holds the last six input bits, the most recent one in bit 0, so the state after a byte is
+       * its six least significant bits.
+       */
+      std::vector<std::uint32_t> const & codewords()
+        {
+        static auto const table = []{
+          auto table = std::vector<std::uint32_t>(64 * 256);
+          for(auto state = 0u; state < 64; ++state)
+            {
+            for(auto byte = 0u; byte < 256; ++byte)
+              {
+              auto history = state;
+              auto codeword = std::uint32_t{};
+              for(auto bit = 7; bit >= 0; --bit)
+                {
+                auto const shift_register = history << 1 | (byte >> bit & 1);
+                for(auto const tap : constants::kMotherCodeTaps)
+                  {
+                  codeword = codeword << 1 | __builtin_parity(shift_register & tap);
+                  }
+                history = shift_register & 0x3F;
+                }
+              table[state << 8 | byte] = codeword;
+              }
+            }
+          return table;
+        }();
+        return table;
+        }
+
+      std::size_t kept_bits(std::uint8_t vector)
+        {
+        return __builtin_popcount(constants::kPuncturingVectors[vector - 1]);
+        }
+
+      /**
+       * Collects bits and stores them as complete bytes
+       */
+      struct bit_writer
+        {
+        explicit bit_writer(std::uint8_t * output)
+          : m_output{output}
+          {
+
+          }
+
+        void write(std::uint32_t bits, std::uint8_t count)
+          {
+          m_buffer = m_buffer << count | bits;
+          m_count += count;
+          while(m_count >= 8)
+            {
+            m_count -= 8;
+            *m_output++ = m_buffer >> m_count;
+            }
+          }
+
+        private:
+        std::uint8_t * m_output;
+        std::uint64_t m_buffer{};
+        std::uint8_t m_count{};
+        };
+
+      }
+
+    puncturing_profile_t eep_profile(std::uint16_t bitrate, std::uint8_t protection)
+      {
+      auto const level = protection & 0x03;
+      auto const option = protection >> 2 & 0x07;
+      if(!(protection & 0x20) || option > 1)
+        {
+        throw std::invalid_argument{"protection " + std::to_string(protection) + " is not EEP"};
+        }
+
+      auto const unit = option ? 32 : 8;
+      auto const n = std::size_t{bitrate} / unit;
+      if(!n || bitrate % unit)
+        {
+        throw std::invalid_argument{"EEP bitrate must be a multiple of " + std::to_string(unit) + " kbit/s"};
+        }
+
+      // Table 18 and 19 of EN 300 401, one row per protection level 1 to 4
+      if(option)
+        {
+        static std::uint8_t constexpr vectors[] {10, 6, 4, 2};
+        return {{24 * n - 3, vectors[level]}, {3, std::uint8_t(vectors[level] - 1)}};
+        }
+
+      switch(level)
+        {
+        case 0:
+          return {{6 * n - 3, 24}, {3, 23}};
+        case 1:
+          if(n == 1)
+            {
+            return {{5, 13}, {1, 12}};
+            }
+          return {{2 * n - 3, 14}, {4 * n + 3, 13}};
+        case 2:
+          return {{6 * n - 3, 8}, {3, 7}};
+        default:
+          return {{4 * n - 3, 3}, {2 * n + 3, 2}};
+        }
+      }
+
+    puncturing_profile_t fic_profile(types::transmission_mode const & mode)
+      {
+      auto const blocks = std::size_t{mode.fib_codeword_bits} / (kBlockBytes * 8);
+      return {{blocks - 3, constants::kFICPuncturing}, {3, constants::kFICFinalPuncturing}};
+      }
+
+    std::size_t punctured_bits(puncturing_profile_t const & profile)
+      {
+      auto bits = std::size_t{__builtin_popcount(constants::kTailPuncturingVector)};
+      for(auto const & run : profile)
+        {
+        bits += run.blocks * kBlockBytes * kept_bits(run.vector);
+        }
+      return bits;
+      }
+
+    convolutional_encoder::convolutional_encoder(puncturing_profile_t const & profile)
+      {
+      for(auto const & run : profile)
+        {
+        if(!run.vector || run.vector > 24)
+          {
+          throw std::invalid_argument{"puncturing vector index must be between 1 and 24"};
+          }
+
+        if(run.blocks)
+          {
+          m_runs.push_back({run.blocks * kBlockBytes, add_puncturer(constants::kPuncturingVectors[run.vector - 1])});
+          m_input_size += run.blocks * kBlockBytes;
+          }
+        }
+
+      m_tail_puncturer = add_puncturer(constants::kTailPuncturingVector);
+      m_output_size = punctured_bits(profile) / 8;
+      }
+
+    std::size_t convolutional_encoder::input_size() const
+      {
+      return m_input_size;
+      }
+
+    std::size_t convolutional_encoder::output_size() const
+      {
+      return m_output_size;
+      }
+
+    void convolutional_encoder::encode(std::uint8_t const * input, std::uint8_t * output) const
+      {
+      auto const & table = codewords();
+      auto writer = bit_writer{output};
+      auto state = 0u;
+
+      auto const puncture = [&](std::uint32_t codeword, puncturer const & vector){
+        for(auto part = 0; part < 4; ++part)
+          {
+          writer.write(vector.bits[part][codeword >> (24 - 8 * part) & 0xFF], vector.counts[part]);
+          }
+      };
+
+      for(auto const & run : m_runs)
+        {
+        auto const & vector = m_puncturers[run.puncturer];
+        for(auto const end = input + run.bytes; input != end; ++input)
+          {
+          puncture(table[state << 8 | *input], vector);
+          state = *input & 0x3F;
+          }
+        }
+
+      // The six tail bits flush the register, the last two bits of the zero byte's sub-block are never kept
+      puncture(table[state << 8], m_puncturers[m_tail_puncturer]);
+      }
+
+    std::size_t convolutional_encoder::add_puncturer(std::uint32_t vector)
+      {
+      auto added = puncturer{};
+      for(auto part = 0; part < 4; ++part)
+        {
+        auto const mask = vector >> (24 - 8 * part) & 0xFF;
+        added.counts[part] = __builtin_popcount(mask);
+        for(auto value = 0u; value < 256; ++value)
+          {
+          auto bits = 0u;
+          for(auto bit = 7; bit >= 0; --bit)
+            {
+            if(mask >> bit & 1)
+              {
+              bits = bits << 1 | (value >> bit & 1);
+              }
+            }
+          added.bits[part][value] = bits;
+          }
+        }
+
+      m_puncturers.push_back(added);
+      return m_puncturers.size() - 1;
+      }
+
+    }
+
+  }
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/util/energy_dispersal.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DABIP_ENERGY_DISPERSAL_AVX2
+#endif
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace
+      {
+
+      void xor_words(std::uint8_t * data, std::uint8_t const * sequence, std::size_t length)
+        {
+        auto idx = std::size_t{};
+        for(; idx + 8 <= length; idx += 8)
+          {
+          std::uint64_t word, mask;
+          std::memcpy(&word, data + idx, 8);
+          std::memcpy(&mask, sequence + idx, 8);
+          word ^= mask;
+          std::memcpy(data + idx, &word, 8);
+          }
+
+        for(; idx < length; ++idx)
+          {
+          data[idx] ^= sequence[idx];
+          }
+        }
+
+#ifdef DABIP_ENERGY_DISPERSAL_AVX2
+      __attribute__((target("avx2")))
+      void xor_avx2(std::uint8_t * data, std::uint8_t const * sequence, std::size_t length)
+        {
+        auto idx = std::size_t{};
+        for(; idx + 32 <= length; idx += 32)
+          {
+          auto const word = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + idx));
+          auto const mask = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(sequence + idx));
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + idx), _mm256_xor_si256(word, mask));
+          }
+
+        xor_words(data + idx, sequence + idx, length - idx);
+        }
+#endif
+
+      }
+
+    energy_dispersal::energy_dispersal(std::size_t length)
+      : m_sequence(length),
+        m_kernel{xor_words}
+      {
+      // The register holds the last nine output bits, the most recent one in bit 0
+      auto state = 0x1FFu;
+      for(auto & byte : m_sequence)
+        {
+        for(auto bit = 0; bit < 8; ++bit)
+          {
+          auto const output = (state >> 4 ^ state >> 8) & 1;
+          state = (state << 1 | output) & 0x1FF;
+          byte = byte << 1 | output;
+          }
+        }
+
+#ifdef DABIP_ENERGY_DISPERSAL_AVX2
+      if(__builtin_cpu_supports("avx2"))
+        {
+        m_kernel = xor_avx2;
+        }
+#endif
+      }
+
+    void energy_dispersal::apply(std::uint8_t * data) const
+      {
+      m_kernel(data, m_sequence.data(), m_sequence.size());
+      }
+
+    std::size_t energy_dispersal::size() const
+      {
+      return m_sequence.size();
+      }
+
+    }
+
+  }
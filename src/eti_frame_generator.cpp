@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/eti/eti_frame_generator.h"
+#include "dab/constants/eti_constants.h"
+#include "dab/util/crc16.h"
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace dab
+  {
+
+  using namespace internal;
+
+  namespace
+    {
+
+    void put_word(std::uint8_t * target, std::uint16_t value)
+      {
+      target[0] = value >> 8;
+      target[1] = value;
+      }
+
+    void put_crc(std::uint8_t * target, std::uint8_t const * data, std::size_t length)
+      {
+      put_word(target, ~updateCRC16(0xFFFF, data, length));
+      }
+
+    /**
+     * The number of capacity units an EEP protected sub-channel occupies in the CIF
+     */
+    std::uint16_t capacity_units(eti_subchannel const & subchannel)
+      {
+      auto const protection = subchannel.stream.protection;
+      auto const level = protection & 0x03;
+      auto const option = protection >> 2 & 0x07;
+      if(!(protection & 0x20) || option > 1)
+        {
+        throw std::invalid_argument{"sub-channel " + std::to_string(subchannel.stream.subchannel_id) + " is not EEP protected"};
+        }
+
+      auto const unit = option ? 32 : 8;
+      if(!subchannel.bitrate || subchannel.bitrate % unit)
+        {
+        throw std::invalid_argument{"bitrate of sub-channel " + std::to_string(subchannel.stream.subchannel_id) +
+                                    " must be a multiple of " + std::to_string(unit) + " kbit/s"};
+        }
+
+      return subchannel.bitrate / unit * (option ? constants::kEEPBUnitsPer32kbps[level] : constants::kEEPAUnitsPer8kbps[level]);
+      }
+
+    }
+
+  eti_frame_generator::eti_frame_generator(internal::types::transmission_mode const & mode,
+                                           std::vector<eti_subchannel> const & subchannels)
+    : m_frame(constants::kETIFrameSize, constants::kETIFramePadding),
+      m_offsets(subchannels.size()),
+      m_sizes(subchannels.size())
+    {
+    if(subchannels.empty() || subchannels.size() > constants::kETIMaxStreams)
+      {
+      throw std::invalid_argument{"an ETI frame carries between 1 and 64 sub-channels"};
+      }
+
+    // The streams follow each other in the order of their start addresses, both in the header and in the MST
+    auto order = std::vector<std::size_t>(subchannels.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t left, std::size_t right){
+      return subchannels[left].stream.start_address < subchannels[right].stream.start_address;
+    });
+
+    auto identifiers = std::set<std::uint8_t>{};
+    auto next_free_unit = std::uint16_t{};
+    for(auto const index : order)
+      {
+      auto const & stream = subchannels[index].stream;
+      if(stream.subchannel_id > 63 || !identifiers.insert(stream.subchannel_id).second)
+        {
+        throw std::invalid_argument{"sub-channel identifiers must be unique and less than 64"};
+        }
+
+      if(stream.start_address < next_free_unit)
+        {
+        throw std::invalid_argument{"sub-channel " + std::to_string(stream.subchannel_id) + " overlaps its predecessor"};
+        }
+
+      next_free_unit = stream.start_address + capacity_units(subchannels[index]);
+      if(next_free_unit > constants::kCapacityUnits)
+        {
+        throw std::invalid_argument{"sub-channel " + std::to_string(stream.subchannel_id) + " exceeds the CIF"};
+        }
+      }
+
+    auto const streams = subchannels.size();
+    auto const fic_size = std::size_t{mode.frame_fibs} / mode.frame_cifs * constants::kFIBSize;
+    m_header_end = 8 + 4 * streams + 4;
+
+    auto offset = m_header_end + fic_size;
+    for(auto const index : order)
+      {
+      m_offsets[index] = offset;
+      m_sizes[index] = subchannels[index].bitrate * 3u;
+      offset += m_sizes[index];
+      }
+    m_main_stream_end = offset;
+
+    if(m_main_stream_end + 8 > m_frame.size())
+      {
+      throw std::invalid_argument{"the sub-channels exceed the ETI frame"};
+      }
+
+    // SYNC: no error
+    m_frame[0] = 0xFF;
+
+    // FC: FIC present, stream count, mode and frame length in words, without FCT and frame phase
+    auto const frame_length = (m_main_stream_end - 8) / 4;
+    m_frame[5] = 0x80 | streams;
+    m_frame[6] = (mode.id & 0x03) << 3 | frame_length >> 8;
+    m_frame[7] = frame_length;
+
+    // STC: one per stream, with its length in units of 64 bits
+    auto stc = m_frame.data() + 8;
+    for(auto const index : order)
+      {
+      auto const & stream = subchannels[index].stream;
+      auto const stream_length = m_sizes[index] / 8;
+      stc[0] = stream.subchannel_id << 2 | stream.start_address >> 8;
+      stc[1] = stream.start_address;
+      stc[2] = stream.protection << 2 | stream_length >> 8;
+      stc[3] = stream_length;
+      stc += 4;
+      }
+
+    // EOH: no MNSC, the CRC covers the counters and is computed per frame
+    put_word(stc, 0);
+
+    // FIC: empty FIBs, consisting of the end marker, padding and CRC
+    for(auto fib = m_frame.data() + m_header_end; fib < m_frame.data() + m_header_end + fic_size; fib += constants::kFIBSize)
+      {
+      std::fill(fib, fib + constants::kFIBSize - 2, 0);
+      fib[0] = constants::kFIBEndMarker;
+      put_crc(fib + constants::kFIBSize - 2, fib, constants::kFIBSize - 2);
+      }
+
+    // EOF: RFU, and TIST: no timestamp
+    auto const trailer = m_frame.data() + m_main_stream_end;
+    put_word(trailer + 2, 0xFFFF);
+    std::fill(trailer + 4, trailer + 8, 0xFF);
+    }
+
+  std::uint8_t * eti_frame_generator::subchannel_data(std::size_t index)
+    {
+    return m_frame.data() + m_offsets.at(index);
+    }
+
+  std::size_t eti_frame_generator::subchannel_size(std::size_t index) const
+    {
+    return m_sizes.at(index);
+    }
+
+  byte_vector_t const & eti_frame_generator::build()
+    {
+    auto const fsync = m_frame_count % 2 ? constants::kETIFsyncOdd : constants::kETIFsyncEven;
+    m_frame[1] = fsync >> 16;
+    m_frame[2] = fsync >> 8;
+    m_frame[3] = fsync;
+
+    m_frame[4] = m_frame_count % constants::kETIFrameCountModulus;
+    m_frame[6] = (m_frame[6] & 0x1F) | (m_frame_count % 8) << 5;
+    ++m_frame_count;
+
+    put_crc(m_frame.data() + m_header_end - 2, m_frame.data() + 4, m_header_end - 6);
+    put_crc(m_frame.data() + m_main_stream_end, m_frame.data() + m_header_end, m_main_stream_end - m_header_end);
+    return m_frame;
+    }
+
+  }
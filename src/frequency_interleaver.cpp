@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/modulation/frequency_interleaver.h"
+#include "dab/constants/eti_constants.h"
+
+#include <algorithm>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    frequency_interleaver::frequency_interleaver(types::transmission_mode const & mode)
+      : m_fft_length{mode.fft_length},
+        m_symbols_per_cif{constants::kCapacityUnits * 64u / mode.symbol_bits}
+      {
+      m_table.reserve(mode.carriers);
+
+      auto const fft_length = m_fft_length;
+      auto value = std::size_t{};
+      for(auto idx = std::size_t{1}; idx < fft_length; ++idx)
+        {
+        value = (13 * value + fft_length / 4 - 1) % fft_length;
+        if(value >= fft_length / 8 && value <= fft_length * 7 / 8 && value != fft_length / 2)
+          {
+          // Carrier value - fft_length / 2, wrapped around into the FFT bins
+          m_table.push_back((value + fft_length / 2) % fft_length);
+          }
+        }
+      }
+
+    void frequency_interleaver::interleave(sample_t const * symbols, sample_t * bins) const
+      {
+      std::fill(bins, bins + m_symbols_per_cif * m_fft_length, sample_t{});
+
+      for(auto symbol = std::size_t{}; symbol < m_symbols_per_cif; ++symbol)
+        {
+        for(auto const bin : m_table)
+          {
+          bins[bin] = *symbols++;
+          }
+        bins += m_fft_length;
+        }
+      }
+
+    std::vector<std::uint16_t> const & frequency_interleaver::table() const
+      {
+      return m_table;
+      }
+
+    std::size_t frequency_interleaver::symbols_per_cif() const
+      {
+      return m_symbols_per_cif;
+      }
+
+    }
+
+  }
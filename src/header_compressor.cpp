@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/header_compression/header_compressor.h"
+#include "dab/constants/header_compression_constants.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace dab
+  {
+
+  using namespace internal;
+
+  header_compressor::header_compressor(std::uint8_t context_id) : kContextId{context_id}
+    {
+    }
+
+  byte_vector_t header_compressor::build(byte_vector_t const & payload) const
+    {
+    auto compressed = iobuf{};
+    compressed.assign(payload.begin(), payload.end());
+    build(compressed);
+    return byte_vector_t{compressed.begin(), compressed.end()};
+    }
+
+  void header_compressor::build(iobuf & payload) const
+    {
+    if(payload.size() > 0xFFFF - constants::kIPv4HeaderSize - constants::kUDPHeaderSize)
+      {
+      throw std::length_error{"payload too large for a UDP datagram"};
+      }
+
+    auto const size = payload.size();
+    auto const header = payload.prepend(constants::kCompressedHeaderSize);
+    header[0] = kContextId;
+    header[1] = size >> 8;
+    header[2] = size;
+    }
+
+  }
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/header_compression/header_decompressor.h"
+#include "dab/constants/header_compression_constants.h"
+#include "dab/util/internet_checksum.h"
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  using namespace internal;
+
+  namespace
+    {
+
+    void put_word(byte_vector_t & target, std::size_t offset, std::uint16_t value)
+      {
+      target[offset] = value >> 8;
+      target[offset + 1] = value;
+      }
+
+    void put_long(byte_vector_t & target, std::size_t offset, std::uint32_t value)
+      {
+      put_word(target, offset, value >> 16);
+      put_word(target, offset + 2, value);
+      }
+
+    }
+
+  void header_decompressor::add_context(std::uint8_t context_id, header_context const & context)
+    {
+    m_contexts[context_id] = context;
+    }
+
+  byte_vector_t header_decompressor::build_header(header_context const & context, std::uint16_t payload_length) const
+    {
+    auto const udp_length = std::uint16_t(constants::kUDPHeaderSize + payload_length);
+    auto header = byte_vector_t(constants::kIPv4HeaderSize + constants::kUDPHeaderSize);
+
+    // IPv4 header:
+    header[0] = 0x45; //Version and header length
+    put_word(header, 2, constants::kIPv4HeaderSize + udp_length); //Total length
+    put_word(header, 4, constants::kIPv4DefaultIdentification); //Identification
+    header[8] = constants::kIPv4DefaultTTL;
+    header[9] = constants::kIPProtocolUDP;
+    put_long(header, 12, context.source_address);
+    put_long(header, 16, context.destination_address);
+    put_word(header, 10, ones_complement_fold(ones_complement_add(0, header.data(), constants::kIPv4HeaderSize)));
+
+    // UDP header, the checksum is filled in once the payload is known:
+    put_word(header, 20, context.source_port);
+    put_word(header, 22, context.destination_port);
+    put_word(header, 24, udp_length);
+    return header;
+    }
+
+  pair_status_vector_t header_decompressor::parse(byte_vector_t const & compressed)
+    {
+    if(compressed.size() < constants::kCompressedHeaderSize)
+      {
+      return {parse_status::incomplete, {}};
+      }
+
+    auto const context = m_contexts.find(compressed[0]);
+    if(context == m_contexts.end())
+      {
+      return {parse_status::unknown_context, {}};
+      }
+
+    auto const payload_length = std::uint16_t((compressed[1] << 8) | compressed[2]);
+    if(compressed.size() - constants::kCompressedHeaderSize != payload_length)
+      {
+      return {parse_status::incomplete, {}};
+      }
+
+    auto datagram = build_header(context->second, payload_length);
+    datagram.insert(datagram.end(), compressed.begin() + constants::kCompressedHeaderSize, compressed.end());
+
+    // UDP checksum over the pseudo header, the UDP header and the payload:
+    auto sum = ones_complement_add(0, datagram.data() + 12, constants::kIPv4HeaderSize - 12);
+    sum += constants::kIPProtocolUDP;
+    sum += constants::kUDPHeaderSize + payload_length;
+    sum = ones_complement_add(sum, datagram.data() + constants::kIPv4HeaderSize, datagram.size() - constants::kIPv4HeaderSize);
+    auto const checksum = ones_complement_fold(sum);
+    put_word(datagram, 26, checksum ? checksum : 0xFFFF);
+
+    return {parse_status::ok, datagram};
+    }
+
+  }
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/capture_ingest.h"
+#include "injector/trace.h"
+
+#include <tins/sniffer.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * The time after which a capture without traffic checks whether it should stop
+     */
+    auto constexpr kCaptureTimeout = 100;
+
+    /**
+     * The room left for link layer headers in front of the largest datagram that fits into a data group
+     */
+    auto constexpr kLinkHeaderRoom = 64;
+
+    std::uint16_t read_16(std::uint8_t const * data)
+      {
+      return data[0] << 8 | data[1];
+      }
+
+    }
+
+  /**
+   * A running capture
+   */
+  struct capture_ingest::capture
+    {
+    std::uint16_t port;
+    std::string interface;
+    std::string filter;
+    std::size_t buffer_size;
+    std::atomic<bool> stop;
+    std::thread thread;
+    };
+
+  bool find_ip_datagram(int link_type, std::uint8_t const * frame, std::size_t captured, std::size_t & offset, std::size_t & length)
+    {
+    switch(link_type)
+      {
+      case DLT_EN10MB:
+        {
+        offset = 14;
+        if(captured < offset)
+          {
+          return false;
+          }
+
+        auto type = read_16(frame + 12);
+        while((type == 0x8100 || type == 0x88A8) && captured >= offset + 4)
+          {
+          type = read_16(frame + offset + 2);
+          offset += 4;
+          }
+
+        if(type != 0x0800)
+          {
+          return false;
+          }
+        break;
+        }
+      case DLT_LINUX_SLL:
+        offset = 16;
+        if(captured < offset || read_16(frame + 14) != 0x0800)
+          {
+          return false;
+          }
+        break;
+      case DLT_NULL:
+      case DLT_LOOP:
+        offset = 4;
+        break;
+      case DLT_RAW:
+#if defined(DLT_IPV4)
+      case DLT_IPV4:
+#endif
+        offset = 0;
+        break;
+      default:
+        return false;
+      }
+
+    // Only complete IPv4 datagrams are of use, the total length also tells us where link layer padding begins
+    if(captured < offset + 20 || frame[offset] >> 4 != 4)
+      {
+      return false;
+      }
+
+    length = read_16(frame + offset + 2);
+    return length >= 20 && captured >= offset + length;
+    }
+
+  capture_ingest::capture_ingest(service_directory const & directory, dispatcher & dispatcher)
+    : m_directory{directory},
+      m_dispatcher{dispatcher}
+    {
+    }
+
+  capture_ingest::~capture_ingest()
+    {
+    for(auto & running : m_captures)
+      {
+      running.second->stop = true;
+      }
+
+    for(auto & running : m_captures)
+      {
+      running.second->thread.join();
+      }
+    }
+
+  void capture_ingest::update()
+    {
+    auto const table = m_directory.current();
+
+    for(auto running = m_captures.begin(); running != m_captures.end();)
+      {
+      auto const service = table->services.find(running->first);
+      if(service != table->services.end() && service->second->config.capture == running->second->interface &&
+         service->second->config.capture_filter == running->second->filter &&
+         service->second->config.capture_buffer == running->second->buffer_size)
+        {
+        ++running;
+        continue;
+        }
+
+      running->second->stop = true;
+      running->second->thread.join();
+      running = m_captures.erase(running);
+      }
+
+    for(auto const & service : table->services)
+      {
+      auto const & config = service.second->config;
+      if(config.capture.empty() || m_captures.count(service.first))
+        {
+        continue;
+        }
+
+      auto & target = *m_captures.emplace(service.first, std::unique_ptr<capture>{new capture{}}).first->second;
+      target.port = service.first;
+      target.interface = config.capture;
+      target.filter = config.capture_filter;
+      target.buffer_size = config.capture_buffer;
+      target.stop = false;
+      target.thread = std::thread{[this, &target]{ run(target); }};
+      }
+    }
+
+  void capture_ingest::run(capture & target)
+    {
+    try
+      {
+      auto configuration = Tins::SnifferConfiguration{};
+      configuration.set_filter(target.filter);
+      configuration.set_immediate_mode(true);
+      configuration.set_buffer_size(target.buffer_size);
+      configuration.set_snap_len(dab::internal::constants::kMaxDatagramSize + kLinkHeaderRoom);
+      configuration.set_promisc_mode(true);
+      configuration.set_timeout(kCaptureTimeout);
+
+      // The sniffer sets up the capture, the frames are then read straight from the pcap buffer
+      Tins::Sniffer sniffer{target.interface, configuration};
+      auto const handle = sniffer.get_pcap_handle();
+      auto const link_type = sniffer.link_type();
+      auto services = service_table_cache{m_directory};
+
+      std::clog << "Capturing '" << target.filter << "' on " << target.interface << std::endl;
+
+      while(!target.stop)
+        {
+        pcap_pkthdr * header{};
+        u_char const * frame{};
+
+        auto const result = pcap_next_ex(handle, &header, &frame);
+        if(!result)
+          {
+          continue;
+          }
+        else if(result < 0)
+          {
+          throw std::runtime_error{pcap_geterr(handle)};
+          }
+
+        INJECTOR_TRACE_SCOPE(receive, header->caplen);
+
+        auto offset = std::size_t{};
+        auto length = std::size_t{};
+        auto const complete = find_ip_datagram(link_type, frame, header->caplen, offset, length);
+        if(!complete && length <= dab::internal::constants::kMaxDatagramSize)
+          {
+          continue;
+          }
+
+        auto const & table = services.current();
+        auto const service = table.services.find(target.port);
+        if(service == table.services.end())
+          {
+          continue;
+          }
+
+        // Datagrams that would not fit into a data group are cut short by the snapshot length anyway
+        if(length > dab::internal::constants::kMaxDatagramSize)
+          {
+          service->second->statistics.oversized.add();
+          continue;
+          }
+
+        auto datagram = queued_datagram_t{};
+        datagram.data.assign(frame + offset, frame + offset + length);
+        datagram.ingest_time = std::chrono::steady_clock::now();
+        datagram.service = service->second;
+        datagram.raw = true;
+
+        datagram.service->statistics.datagrams_received.add();
+        datagram.service->statistics.bytes_received.add(length);
+        m_dispatcher.dispatch(std::move(datagram));
+        }
+      }
+    catch(std::exception const & error)
+      {
+      std::cerr << "Error: capture on " << target.interface << " failed: " << error.what() << '\n';
+      }
+    }
+
+  }
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/configuration.h"
+
+#include "INIReader.h"
+
+#include <dab/edi/pft_generator.h>
+
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * Split a comma separated list of values, discarding surrounding whitespace
+     */
+    std::vector<std::string> split_list(std::string const & list)
+      {
+      auto values = std::vector<std::string>{};
+      auto stream = std::istringstream{list};
+      auto value = std::string{};
+
+      while(std::getline(stream, value, ','))
+        {
+        auto const begin = value.find_first_not_of(" \t");
+        if(begin != std::string::npos)
+          {
+          values.push_back(value.substr(begin, value.find_last_not_of(" \t") - begin + 1));
+          }
+        }
+      return values;
+      }
+
+    /**
+     * Read a service from the given sections
+     */
+    service_configuration_t read_service(INIReader & ini, std::string const & name, std::string const & section,
+                                         std::string const & source, std::string const & destination)
+      {
+      auto service = service_configuration_t{};
+      service.name                = name;
+      service.port                = ini.GetInteger(section + ".port", service.port);
+      service.group               = ini.Get(section + ".group", service.group);
+      service.interface           = ini.Get(section + ".interface", service.interface);
+      service.stream              = ini.Get(section + ".stream", service.stream);
+      service.capture             = ini.Get(section + ".capture", service.capture);
+      service.capture_filter      = ini.Get(section + ".filter", service.capture_filter);
+      service.capture_buffer      = ini.GetInteger(section + ".capture_buffer", service.capture_buffer >> 20) << 20;
+      service.packet_address      = ini.GetInteger(section + ".address", service.packet_address);
+      service.source_address      = ini.Get(source + ".address", service.source_address);
+      service.source_port         = ini.GetInteger(source + ".port", service.source_port);
+      service.destination_address = ini.Get(destination + ".address", service.destination_address);
+      service.destination_port    = ini.GetInteger(destination + ".port", service.destination_port);
+      service.header_context_id   = ini.GetInteger(section + ".header_context", service.header_context_id);
+
+      auto const header_compression = ini.Get(section + ".header_compression", "none");
+      if(header_compression != "none" && header_compression != "static")
+        {
+        throw std::invalid_argument{"unknown header compression '" + header_compression + "' for service '" + name + "'"};
+        }
+      service.compress_headers = header_compression == "static";
+
+      auto const compression = ini.Get(section + ".compression", "none");
+      if(compression != "none" && compression != "deflate")
+        {
+        throw std::invalid_argument{"unknown payload compression '" + compression + "' for service '" + name + "'"};
+        }
+      service.compression_level      = compression == "deflate" ? ini.GetInteger(section + ".compression_level", 6) : -1;
+      service.compression_dictionary = ini.Get(section + ".compression_dictionary", service.compression_dictionary);
+
+      // Services without a time to live of their own share the one of the [packet] section
+      auto const time_to_live = ini.GetInteger(section + ".ttl", ini.GetInteger("packet.ttl", service.time_to_live.count()));
+      if(time_to_live < 0)
+        {
+        throw std::invalid_argument{"time to live of service '" + name + "' must not be negative"};
+        }
+      service.time_to_live = std::chrono::milliseconds{time_to_live};
+
+      if(service.packet_address >= 1024)
+        {
+        throw std::invalid_argument{"packet address of service '" + name + "' must be less than 1024"};
+        }
+
+      return service;
+      }
+
+    /**
+     * Read an output from the given section
+     */
+    output_configuration_t read_output(INIReader & ini, std::string const & name, std::string const & section)
+      {
+      auto output = output_configuration_t{};
+      output.name                      = name;
+      output.type                      = ini.Get(section + ".type", output.type);
+      output.path                      = ini.Get(section + ".path", output.type == "shm" ? "/dabdata" : output.path);
+      output.truncate                  = ini.GetBoolean(section + ".truncate", output.truncate);
+      output.slots                     = ini.GetInteger(section + ".slots", output.slots);
+      output.destinations              = split_list(ini.Get(section + ".destinations", ""));
+      output.queue_size                = ini.GetInteger(section + ".queue_size", output.queue_size);
+
+      output.edi.destinations          = output.destinations;
+      output.edi.bitrate               = ini.GetInteger(section + ".bitrate", output.edi.bitrate);
+      output.edi.stream.subchannel_id  = ini.GetInteger(section + ".subchannel", output.edi.stream.subchannel_id);
+      output.edi.stream.start_address  = ini.GetInteger(section + ".start_address", output.edi.stream.start_address);
+      output.edi.stream.protection     = ini.GetInteger(section + ".protection", output.edi.stream.protection);
+      output.edi.pft                   = ini.GetBoolean(section + ".pft", output.edi.pft);
+      auto const fec                   = ini.GetInteger(section + ".fec", output.edi.fec);
+      output.edi.fragment_size         = ini.GetInteger(section + ".fragment_size", output.edi.fragment_size);
+      output.edi.tai_offset            = ini.GetInteger(section + ".tai_offset", output.edi.tai_offset);
+      output.edi.mode                  = ini.GetInteger(section + ".mode", output.edi.mode);
+      output.edi.backlog               = ini.GetInteger(section + ".backlog", output.edi.backlog);
+
+      auto const types = std::set<std::string>{"fifo", "file", "udp", "shm", "edi", "eti"};
+      if(!types.count(output.type))
+        {
+        throw std::invalid_argument{"unknown output type '" + output.type + "' for output '" + name + "'"};
+        }
+
+      if(fec < 0 || fec > dab::pft_generator::kMaxRecoverable)
+        {
+        throw std::invalid_argument{"fec of output '" + name + "' must be between 0 and " + std::to_string(dab::pft_generator::kMaxRecoverable)};
+        }
+      output.edi.fec = static_cast<std::uint8_t>(fec);
+
+      if(!output.edi.backlog)
+        {
+        throw std::invalid_argument{"backlog of output '" + name + "' must hold at least one frame"};
+        }
+
+      return output;
+      }
+
+    }
+
+  bool operator==(service_configuration_t const & lhs, service_configuration_t const & rhs)
+    {
+    return std::tie(lhs.name, lhs.port, lhs.group, lhs.interface, lhs.stream, lhs.capture, lhs.capture_filter,
+                    lhs.capture_buffer, lhs.packet_address, lhs.destination_address,
+                    lhs.destination_port, lhs.source_address, lhs.source_port, lhs.compress_headers, lhs.header_context_id,
+                    lhs.compression_level, lhs.compression_dictionary) ==
+           std::tie(rhs.name, rhs.port, rhs.group, rhs.interface, rhs.stream, rhs.capture, rhs.capture_filter,
+                    rhs.capture_buffer, rhs.packet_address, rhs.destination_address,
+                    rhs.destination_port, rhs.source_address, rhs.source_port, rhs.compress_headers, rhs.header_context_id,
+                    rhs.compression_level, rhs.compression_dictionary);
+    }
+
+  bool operator!=(service_configuration_t const & lhs, service_configuration_t const & rhs)
+    {
+    return !(lhs == rhs);
+    }
+
+  bool operator==(output_configuration_t const & lhs, output_configuration_t const & rhs)
+    {
+    return std::tie(lhs.name, lhs.type, lhs.path, lhs.truncate, lhs.slots, lhs.destinations, lhs.queue_size, lhs.edi.bitrate,
+                    lhs.edi.stream.subchannel_id, lhs.edi.stream.start_address, lhs.edi.stream.protection, lhs.edi.pft,
+                    lhs.edi.fec, lhs.edi.fragment_size, lhs.edi.tai_offset, lhs.edi.mode, lhs.edi.backlog) ==
+           std::tie(rhs.name, rhs.type, rhs.path, rhs.truncate, rhs.slots, rhs.destinations, rhs.queue_size, rhs.edi.bitrate,
+                    rhs.edi.stream.subchannel_id, rhs.edi.stream.start_address, rhs.edi.stream.protection, rhs.edi.pft,
+                    rhs.edi.fec, rhs.edi.fragment_size, rhs.edi.tai_offset, rhs.edi.mode, rhs.edi.backlog);
+    }
+
+  bool operator!=(output_configuration_t const & lhs, output_configuration_t const & rhs)
+    {
+    return !(lhs == rhs);
+    }
+
+  configuration_t read_configuration(std::string const & file)
+    {
+    INIReader ini(file);
+    auto const line = ini.ParseError();
+    if(line < 0)
+      {
+      throw std::runtime_error{"cannot open configuration file '" + file + "'"};
+      }
+    else if(line)
+      {
+      throw std::runtime_error{"cannot read configuration file '" + file + "' (error at line " + std::to_string(line) + ")"};
+      }
+
+    auto conf = configuration_t{};
+
+    auto const prefix = std::string{"service."};
+    auto const output_prefix = std::string{"output."};
+    for(auto const & section : ini.Sections())
+      {
+      // The reader stores its keys in lower case
+      auto key = section;
+      std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+      if(!key.compare(0, prefix.size(), prefix))
+        {
+        conf.services.push_back(read_service(ini, section.substr(prefix.size()), key, key + ".source", key + ".destination"));
+        }
+      else if(!key.compare(0, output_prefix.size(), output_prefix))
+        {
+        conf.outputs.push_back(read_output(ini, section.substr(output_prefix.size()), key));
+        }
+      }
+
+    if(conf.services.empty())
+      {
+      conf.services.push_back(read_service(ini, "default", "packet", "source", "destination"));
+      }
+
+    auto ports = std::set<std::uint16_t>{};
+    auto addresses = std::set<std::uint16_t>{};
+    for(auto const & service : conf.services)
+      {
+      if(!ports.insert(service.port).second)
+        {
+        throw std::invalid_argument{"port " + std::to_string(service.port) + " is used by more than one service"};
+        }
+
+      if(!addresses.insert(service.packet_address).second)
+        {
+        throw std::invalid_argument{"packet address " + std::to_string(service.packet_address) + " is used by more than one service"};
+        }
+      }
+
+    conf.receivers           = ini.GetInteger("input.receivers", conf.receivers);
+    conf.packagers           = ini.GetInteger("input.packagers", conf.packagers);
+    conf.compressors         = ini.GetInteger("input.compressors", conf.compressors);
+    conf.queue_size          = ini.GetInteger("input.queue_size", conf.queue_size);
+    conf.input_backend       = ini.Get("input.backend", conf.input_backend);
+    if(!conf.receivers || !conf.packagers || !conf.compressors)
+      {
+      throw std::invalid_argument{"at least one receiver, compressor and packager thread are required"};
+      }
+
+    if(conf.input_backend != "asio" && conf.input_backend != "uring")
+      {
+      throw std::invalid_argument{"unknown input backend '" + conf.input_backend + "'"};
+      }
+
+    if(conf.outputs.empty())
+      {
+      conf.outputs.push_back(read_output(ini, "default", "output"));
+      }
+
+    auto outputs = std::set<std::string>{};
+    for(auto const & output : conf.outputs)
+      {
+      if(!outputs.insert(output.name).second)
+        {
+        throw std::invalid_argument{"output name '" + output.name + "' is used more than once"};
+        }
+      }
+
+    conf.metrics_endpoint    = ini.Get("metrics.listen", conf.metrics_endpoint);
+
+    conf.replay.file         = ini.Get("replay.file", conf.replay.file);
+    conf.replay.speed        = ini.GetReal("replay.speed", conf.replay.speed);
+    if(conf.replay.speed < 0)
+      {
+      throw std::invalid_argument{"replay speed must not be negative"};
+      }
+
+    return conf;
+    }
+
+  }
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/dispatch.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <climits>
+#include <utility>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * The number of times an idle packager polls its queue before parking
+     */
+    auto constexpr kSpinCount = 1000u;
+
+    /**
+     * The longest time a parked packager sleeps before checking its queue again
+     */
+    auto constexpr kParkTimeout = timespec{0, 10000000};
+
+    }
+
+  void room_waiters::add(std::function<void()> waiter)
+    {
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    m_waiters.push_back(std::move(waiter));
+    m_waiting.store(true, std::memory_order_relaxed);
+    }
+
+    // Pairs with the fence in notify, so that either the consumer sees the callback or the caller sees the room
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+  void room_waiters::notify()
+    {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(!m_waiting.load(std::memory_order_relaxed))
+      {
+      return;
+      }
+
+    auto waiters = std::vector<std::function<void()>>{};
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    waiters.swap(m_waiters);
+    m_waiting.store(false, std::memory_order_relaxed);
+    }
+
+    for(auto const & waiter : waiters)
+      {
+      waiter();
+      }
+    }
+
+  compression_queue::compression_queue(std::size_t capacity)
+    : m_capacity{capacity}
+    {
+    }
+
+  bool compression_queue::try_enqueue(queued_datagram_t && datagram)
+    {
+    // The compressor only ever lags behind by a bounded number of datagrams, too
+    if(m_queue.approximate_size() >= m_capacity)
+      {
+      return false;
+      }
+
+    m_queue.enqueue(std::move(datagram));
+    return true;
+    }
+
+  void compression_queue::dequeue(queued_datagram_t & datagram)
+    {
+    m_queue.dequeue(datagram);
+    m_waiters.notify();
+    }
+
+  void compression_queue::when_room(std::function<void()> waiter)
+    {
+    m_waiters.add(std::move(waiter));
+    if(m_queue.approximate_size() < m_capacity)
+      {
+      m_waiters.notify();
+      }
+    }
+
+  std::size_t compression_queue::approximate_size() const
+    {
+    return m_queue.approximate_size();
+    }
+
+  packager_queue::packager_queue(std::size_t capacity)
+    : m_queue{capacity}
+    {
+    }
+
+  bool packager_queue::try_enqueue(queued_datagram_t && datagram)
+    {
+    if(!m_queue.try_enqueue(std::move(datagram)))
+      {
+      return false;
+      }
+
+    wake_packager();
+    return true;
+    }
+
+  void packager_queue::enqueue(queued_datagram_t && datagram)
+    {
+    while(!m_queue.try_enqueue(std::move(datagram)))
+      {
+      // Pairs with the fence in dequeue, so that either we see the room it made or it sees us waiting.
+      // The flag is only ever cleared by the packager, so that it wakes every producer waiting at once.
+      m_full.store(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(m_queue.try_enqueue(std::move(datagram)))
+        {
+        break;
+        }
+
+      syscall(SYS_futex, &m_full, FUTEX_WAIT_PRIVATE, 1, &kParkTimeout, nullptr, 0);
+      }
+
+    wake_packager();
+    }
+
+  void packager_queue::wake_packager()
+    {
+    // Pairs with the fence in dequeue, so that either the packager sees the datagram or we see it parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_parked.load(std::memory_order_relaxed) && m_parked.exchange(0))
+      {
+      syscall(SYS_futex, &m_parked, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+      }
+    }
+
+  void packager_queue::dequeue(queued_datagram_t & datagram)
+    {
+    for(auto spins = 0u; !m_queue.try_dequeue(datagram); ++spins)
+      {
+      if(spins < kSpinCount)
+        {
+        continue;
+        }
+
+      m_parked.store(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(m_queue.try_dequeue(datagram))
+        {
+        m_parked.store(0, std::memory_order_relaxed);
+        break;
+        }
+
+      syscall(SYS_futex, &m_parked, FUTEX_WAIT_PRIVATE, 1, &kParkTimeout, nullptr, 0);
+      m_parked.store(0, std::memory_order_relaxed);
+      spins = 0;
+      }
+
+    // Pairs with the fence in enqueue, so that either a waiting producer sees the room or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_full.load(std::memory_order_relaxed) && m_full.exchange(0))
+      {
+      syscall(SYS_futex, &m_full, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+      }
+    m_waiters.notify();
+    }
+
+  void packager_queue::when_room(std::function<void()> waiter)
+    {
+    m_waiters.add(std::move(waiter));
+    if(m_queue.approximate_size() < m_queue.capacity())
+      {
+      m_waiters.notify();
+      }
+    }
+
+  std::size_t packager_queue::approximate_size() const
+    {
+    return m_queue.approximate_size();
+    }
+
+  dispatcher::dispatcher(std::size_t packagers, std::size_t capacity, std::size_t compressors)
+    {
+    for(auto idx = std::size_t{}; idx < compressors; ++idx)
+      {
+      m_compression_queues.emplace_back(new compression_queue{capacity});
+      }
+
+    for(auto idx = std::size_t{}; idx < packagers; ++idx)
+      {
+      m_packager_queues.emplace_back(new packager_queue{capacity});
+      }
+    }
+
+  void dispatcher::dispatch(queued_datagram_t && datagram)
+    {
+    if(!try_dispatch(std::move(datagram)))
+      {
+      datagram.service->statistics.overflow.add();
+      }
+    }
+
+  bool dispatcher::try_dispatch(queued_datagram_t && datagram)
+    {
+    if(!datagram.service->compressor || datagram.raw)
+      {
+      return try_package(std::move(datagram));
+      }
+
+    return compressor_of(*datagram.service).try_enqueue(std::move(datagram));
+    }
+
+  bool dispatcher::try_package(queued_datagram_t && datagram)
+    {
+    return packager_of(*datagram.service).try_enqueue(std::move(datagram));
+    }
+
+  void dispatcher::package(queued_datagram_t && datagram)
+    {
+    packager_of(*datagram.service).enqueue(std::move(datagram));
+    }
+
+  void dispatcher::when_room(queued_datagram_t const & datagram, std::function<void()> waiter)
+    {
+    if(!datagram.service->compressor || datagram.raw)
+      {
+      packager_of(*datagram.service).when_room(std::move(waiter));
+      }
+    else
+      {
+      compressor_of(*datagram.service).when_room(std::move(waiter));
+      }
+    }
+
+  compression_queue & dispatcher::compressor_of(service_t const & service)
+    {
+    return *m_compression_queues[service.config.packet_address % m_compression_queues.size()];
+    }
+
+  std::vector<std::unique_ptr<compression_queue>> const & dispatcher::compression_queues() const
+    {
+    return m_compression_queues;
+    }
+
+  packager_queue & dispatcher::packager_of(service_t const & service)
+    {
+    return *m_packager_queues[service.config.packet_address % m_packager_queues.size()];
+    }
+
+  std::vector<std::unique_ptr<packager_queue>> const & dispatcher::packager_queues() const
+    {
+    return m_packager_queues;
+    }
+
+  }
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/edi_output.h"
+
+#include <dab/constants/edi_constants.h>
+#include <dab/util/vector_helpers.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+namespace injector
+  {
+
+  using namespace dab::internal;
+
+  namespace
+    {
+
+    /**
+     * The duration of a single DAB logical frame
+     */
+    auto constexpr kFrameDuration = std::chrono::milliseconds{24};
+
+    }
+
+  edi_output::edi_output(edi_parameters_t const & parameters, counter & dropped)
+    : m_parameters{parameters},
+      m_frame_size{parameters.bitrate * 3u},
+      m_stream{parameters.backlog * m_frame_size, dropped}
+    {
+    if(!m_parameters.bitrate || m_parameters.bitrate % 8)
+      {
+      throw std::invalid_argument{"EDI sub-channel bitrate must be a multiple of 8 kbit/s"};
+      }
+
+    if(m_parameters.mode < 1 || m_parameters.mode > 4)
+      {
+      throw std::invalid_argument{"EDI transmission mode must be between 1 and 4"};
+      }
+
+    if(m_parameters.destinations.empty())
+      {
+      throw std::invalid_argument{"EDI output requires at least one destination"};
+      }
+
+    m_destinations.resize(m_parameters.destinations.size());
+    m_destination_lengths.resize(m_parameters.destinations.size());
+    for(auto idx = std::size_t{}; idx < m_destinations.size(); ++idx)
+      {
+      resolve(m_parameters.destinations[idx], m_destinations[idx], m_destination_lengths[idx]);
+      }
+
+    if(m_parameters.pft)
+      {
+      m_pft_generator.reset(new dab::pft_generator{m_parameters.fec, m_parameters.fragment_size});
+      }
+
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if(m_socket < 0)
+      {
+      throw std::system_error{errno, std::generic_category(), "cannot create EDI socket"};
+      }
+
+    m_thread = std::thread{&edi_output::run, this};
+    }
+
+  edi_output::~edi_output()
+    {
+    m_running = false;
+    m_thread.join();
+    close(m_socket);
+    }
+
+  void edi_output::write(dab::buffer_chain const & packets)
+    {
+    m_stream.append(packets);
+    }
+
+  void edi_output::run()
+    {
+    auto deadline = std::chrono::steady_clock::now();
+
+    while(m_running)
+      {
+      deadline += kFrameDuration;
+      std::this_thread::sleep_until(deadline);
+
+      try
+        {
+        auto af_packet = build_af_packet(take_frame());
+        if(m_pft_generator)
+          {
+          send(m_pft_generator->build(af_packet));
+          }
+        else
+          {
+          send({std::move(af_packet)});
+          }
+        }
+      catch(std::exception const & error)
+        {
+        std::cerr << "Error: " << error.what() << '\n';
+        }
+      }
+    }
+
+  dab::byte_vector_t edi_output::take_frame()
+    {
+    auto frame = dab::byte_vector_t(m_frame_size);
+    m_stream.take(frame.data(), frame.size());
+    return frame;
+    }
+
+  dab::byte_vector_t edi_output::build_af_packet(dab::byte_vector_t const & frame)
+    {
+    auto const now = std::chrono::system_clock::now().time_since_epoch();
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(now);
+    auto const fraction = std::chrono::duration_cast<std::chrono::nanoseconds>(now - seconds);
+
+    auto deti = dab::deti_parameters{};
+    deti.frame_count = m_frame_count;
+    deti.mode_id = m_parameters.mode;
+    deti.utc_offset = m_parameters.tai_offset - constants::kTAIOffsetBias;
+    deti.seconds = seconds.count() - constants::kEpoch2000 + m_parameters.tai_offset;
+    deti.ticks = fraction.count() * (constants::kTimestampTicksPerSecond / 1000) / 1000000;
+    m_frame_count = (m_frame_count + 1) % constants::kDLFCModulus;
+
+    auto tag_items = dab::build_ptr_tag();
+    concat_vectors_inplace(tag_items, dab::build_deti_tag(deti), dab::build_est_tag(m_parameters.stream, frame));
+    return m_af_generator.build(tag_items);
+    }
+
+  void edi_output::send(std::vector<dab::byte_vector_t> const & datagrams)
+    {
+    auto const destinations = m_destinations.size();
+    auto vectors = std::vector<iovec>(datagrams.size());
+    auto messages = std::vector<mmsghdr>(datagrams.size() * destinations);
+
+    for(auto datagram = std::size_t{}; datagram < datagrams.size(); ++datagram)
+      {
+      vectors[datagram].iov_base = const_cast<std::uint8_t *>(datagrams[datagram].data());
+      vectors[datagram].iov_len = datagrams[datagram].size();
+
+      for(auto destination = std::size_t{}; destination < destinations; ++destination)
+        {
+        auto & header = messages[datagram * destinations + destination].msg_hdr;
+        header.msg_name = &m_destinations[destination];
+        header.msg_namelen = m_destination_lengths[destination];
+        header.msg_iov = &vectors[datagram];
+        header.msg_iovlen = 1;
+        }
+      }
+
+    for(auto sent = std::size_t{}; sent < messages.size();)
+      {
+      auto const result = sendmmsg(m_socket, messages.data() + sent, messages.size() - sent, 0);
+      if(result < 0)
+        {
+        if(errno == EINTR)
+          {
+          continue;
+          }
+        throw std::system_error{errno, std::generic_category(), "cannot send EDI frame"};
+        }
+      sent += result;
+      }
+    }
+
+  }
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/eti_output.h"
+
+#include <dab/constants/transmission_modes.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * The duration of a single ETI frame
+     */
+    auto constexpr kFrameDuration = std::chrono::milliseconds{24};
+
+    dab::internal::types::transmission_mode const & transmission_mode(std::uint8_t mode)
+      {
+      switch(mode)
+        {
+        case 1:
+          return dab::kTransmissionMode1;
+        case 2:
+          return dab::kTransmissionMode2;
+        case 3:
+          return dab::kTransmissionMode3;
+        case 4:
+          return dab::kTransmissionMode4;
+        default:
+          throw std::invalid_argument{"ETI transmission mode must be between 1 and 4"};
+        }
+      }
+
+    }
+
+  eti_output::eti_output(std::string const & path, bool truncate, edi_parameters_t const & parameters, counter & dropped)
+    : m_generator{transmission_mode(parameters.mode), {dab::eti_subchannel{parameters.stream, parameters.bitrate}}},
+      m_stream{parameters.backlog * m_generator.subchannel_size(0), dropped}
+    {
+    m_descriptor = open(path.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : O_APPEND) | O_CLOEXEC, 0644);
+    if(m_descriptor < 0)
+      {
+      throw std::runtime_error{"cannot open ETI output '" + path + "'"};
+      }
+
+    m_thread = std::thread{&eti_output::run, this};
+    }
+
+  eti_output::~eti_output()
+    {
+    m_running = false;
+    m_thread.join();
+    close(m_descriptor);
+    }
+
+  void eti_output::write(dab::buffer_chain const & packets)
+    {
+    m_stream.append(packets);
+    }
+
+  void eti_output::run()
+    {
+    auto deadline = std::chrono::steady_clock::now();
+
+    while(m_running)
+      {
+      deadline += kFrameDuration;
+      std::this_thread::sleep_until(deadline);
+
+      try
+        {
+        m_stream.take(m_generator.subchannel_data(0), m_generator.subchannel_size(0));
+        write_frame(m_generator.build());
+        }
+      catch(std::exception const & error)
+        {
+        std::cerr << "Error: " << error.what() << '\n';
+        }
+      }
+    }
+
+  void eti_output::write_frame(dab::byte_vector_t const & frame)
+    {
+    for(auto written = std::size_t{}; written < frame.size();)
+      {
+      auto const result = ::write(m_descriptor, frame.data() + written, frame.size() - written);
+      if(result < 0)
+        {
+        if(errno == EINTR)
+          {
+          continue;
+          }
+        throw std::system_error{errno, std::system_category(), "cannot write ETI frame"};
+        }
+      written += result;
+      }
+    }
+
+  }
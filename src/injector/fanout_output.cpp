@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/fanout_output.h"
+#include "injector/metrics.h"
+
+#include <dab/types/bounded_queue.h>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * The time an idle writer sleeps before checking its queue again, in case a wake-up was lost
+     */
+    auto constexpr kParkTimeout = timespec{0, 100000000};
+
+    /**
+     * The time a failed output is left alone before it is reopened
+     */
+    auto constexpr kReopenDelay = std::chrono::seconds{1};
+
+    }
+
+  struct fanout_output::sink
+    {
+    sink(std::string const & name, factory_t open, std::size_t queue_size)
+      : name{name},
+        open{std::move(open)},
+        queue{queue_size},
+        written{metrics().make_counter("dab_injector_output_bytes_total", "Packet bytes written to an output", "output=\"" + name + "\"")},
+        dropped{output_dropped(name)}
+      {
+      }
+
+    /**
+     * Queue a block, dropping it if the writer fell too far behind
+     */
+    void push(shared_packets_t const & packets)
+      {
+      auto reference = packets;
+      if(!queue.try_enqueue(std::move(reference)))
+        {
+        dropped.add();
+        return;
+        }
+
+      // Pairs with the fence in pop, so that either the writer sees the block or we see it parked
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(parked.load(std::memory_order_relaxed) && parked.exchange(0))
+        {
+        syscall(SYS_futex, &parked, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+        }
+      }
+
+    /**
+     * Take the next block, parking the writer until there is one
+     */
+    void pop(shared_packets_t & packets)
+      {
+      while(!queue.try_dequeue(packets))
+        {
+        parked.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(queue.try_dequeue(packets))
+          {
+          parked.store(0, std::memory_order_relaxed);
+          return;
+          }
+
+        syscall(SYS_futex, &parked, FUTEX_WAIT_PRIVATE, 1, &kParkTimeout, nullptr, 0);
+        parked.store(0, std::memory_order_relaxed);
+        }
+      }
+
+    void run()
+      {
+      auto target = std::unique_ptr<output>{};
+      auto failed_at = std::chrono::steady_clock::time_point{};
+      auto packets = shared_packets_t{};
+
+      while(true)
+        {
+        pop(packets);
+
+        try
+          {
+          if(!target)
+            {
+            if(failed_at != std::chrono::steady_clock::time_point{} && std::chrono::steady_clock::now() - failed_at < kReopenDelay)
+              {
+              dropped.add();
+              packets.reset();
+              continue;
+              }
+            target = open();
+            std::clog << "Output " << name << " opened" << std::endl;
+            }
+
+          target->write(*packets);
+          written.add(packets->size());
+          }
+        catch(std::exception const & error)
+          {
+          std::cerr << "Error: output " << name << ": " << error.what() << '\n';
+          dropped.add();
+          target.reset();
+          failed_at = std::chrono::steady_clock::now();
+          }
+
+        // Let go of the block right away rather than holding it until the next one arrives
+        packets.reset();
+        }
+      }
+
+    std::string const name;
+    factory_t const open;
+    dab::internal::bounded_queue<shared_packets_t> queue;
+    std::atomic<std::uint32_t> parked{};
+    counter & written;
+    counter & dropped;
+    };
+
+  counter & output_dropped(std::string const & name)
+    {
+    return metrics().make_counter("dab_injector_output_dropped_total", "Blocks of packets an output dropped", "output=\"" + name + "\"");
+    }
+
+  void fanout_output::add(std::string const & name, factory_t open, std::size_t queue_size)
+    {
+    auto const added = std::make_shared<sink>(name, std::move(open), queue_size);
+    metrics().make_gauge("dab_injector_queue_depth", "Datagrams waiting in a queue", "queue=\"output\",output=\"" + name + "\"",
+        [added]{ return added->queue.approximate_size(); });
+
+    // The writer keeps its sink alive, it may be stuck in a write long after we are gone
+    std::thread{[added]{ added->run(); }}.detach();
+    m_sinks.push_back(added);
+    }
+
+  void fanout_output::write(shared_packets_t const & packets)
+    {
+    for(auto const & target : m_sinks)
+      {
+      target->push(packets);
+      }
+    }
+
+  }
@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/metrics.h"
+
+#include <cmath>
+#include <set>
+#include <sstream>
+
+namespace injector
+  {
+
+  std::size_t constexpr histogram::kSubBucketBits;
+  std::size_t constexpr histogram::kBuckets;
+
+  std::size_t thread_shard()
+    {
+    static std::atomic<std::size_t> next{};
+    thread_local auto const shard = next++ % kMetricShards;
+    return shard;
+    }
+
+  std::uint64_t counter::value() const
+    {
+    auto total = std::uint64_t{};
+    for(auto const & shard : m_shards)
+      {
+      total += shard.value.load(std::memory_order_relaxed);
+      }
+    return total;
+    }
+
+  std::size_t histogram::bucket(std::uint64_t value)
+    {
+    auto const half = std::size_t{1} << (kSubBucketBits - 1);
+    if(value < 2 * half)
+      {
+      return value;
+      }
+
+    auto const shift = (63 - __builtin_clzll(value)) - (kSubBucketBits - 1);
+    auto const index = (shift << (kSubBucketBits - 1)) + (value >> shift);
+    return index < kBuckets ? index : kBuckets - 1;
+    }
+
+  std::uint64_t histogram::upper_bound(std::size_t bucket)
+    {
+    auto const half = std::size_t{1} << (kSubBucketBits - 1);
+    if(bucket < 2 * half)
+      {
+      return bucket;
+      }
+
+    auto const shift = bucket / half - 1;
+    return ((bucket - shift * half + 1) << shift) - 1;
+    }
+
+  std::uint64_t histogram::count_below(std::uint64_t bound) const
+    {
+    auto total = std::uint64_t{};
+    for(auto const & shard : m_shards)
+      {
+      for(auto idx = std::size_t{}; idx < kBuckets && upper_bound(idx) <= bound; ++idx)
+        {
+        total += shard.buckets[idx].load(std::memory_order_relaxed);
+        }
+      }
+    return total;
+    }
+
+  std::uint64_t histogram::count() const
+    {
+    auto total = std::uint64_t{};
+    for(auto const & shard : m_shards)
+      {
+      for(auto const & bucket : shard.buckets)
+        {
+        total += bucket.load(std::memory_order_relaxed);
+        }
+      }
+    return total;
+    }
+
+  std::uint64_t histogram::sum() const
+    {
+    auto total = std::uint64_t{};
+    for(auto const & shard : m_shards)
+      {
+      total += shard.sum.load(std::memory_order_relaxed);
+      }
+    return total;
+    }
+
+  std::uint64_t histogram::quantile(double fraction) const
+    {
+    auto counts = std::array<std::uint64_t, kBuckets>{};
+    auto total = std::uint64_t{};
+    for(auto const & shard : m_shards)
+      {
+      for(auto idx = std::size_t{}; idx < kBuckets; ++idx)
+        {
+        auto const count = shard.buckets[idx].load(std::memory_order_relaxed);
+        counts[idx] += count;
+        total += count;
+        }
+      }
+
+    auto const rank = static_cast<std::uint64_t>(std::ceil(fraction * total));
+    auto seen = std::uint64_t{};
+    for(auto idx = std::size_t{}; idx < kBuckets; ++idx)
+      {
+      seen += counts[idx];
+      if(seen && seen >= rank)
+        {
+        return upper_bound(idx);
+        }
+      }
+    return 0;
+    }
+
+  counter & metrics_registry::make_counter(std::string const & name, std::string const & help, std::string const & labels)
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    if(auto const existing = find(name, labels))
+      {
+      return *existing->counter_metric;
+      }
+
+    m_counters.emplace_back();
+    m_entries.push_back(entry{name, help, "counter", labels, &m_counters.back(), nullptr, nullptr});
+    return m_counters.back();
+    }
+
+  histogram & metrics_registry::make_histogram(std::string const & name, std::string const & help, std::string const & labels)
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    if(auto const existing = find(name, labels))
+      {
+      return *existing->histogram_metric;
+      }
+
+    m_histograms.emplace_back();
+    m_entries.push_back(entry{name, help, "histogram", labels, nullptr, &m_histograms.back(), nullptr});
+    return m_histograms.back();
+    }
+
+  void metrics_registry::make_gauge(std::string const & name, std::string const & help, std::string const & labels, std::function<double()> sample)
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    if(auto const existing = find(name, labels))
+      {
+      existing->sample = std::move(sample);
+      return;
+      }
+
+    m_entries.push_back(entry{name, help, "gauge", labels, nullptr, nullptr, std::move(sample)});
+    }
+
+  metrics_registry::entry * metrics_registry::find(std::string const & name, std::string const & labels)
+    {
+    for(auto & metric : m_entries)
+      {
+      if(metric.name == name && metric.labels == labels)
+        {
+        return &metric;
+        }
+      }
+    return nullptr;
+    }
+
+  std::string metrics_registry::render() const
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    auto output = std::ostringstream{};
+    auto rendered = std::set<std::string>{};
+
+    for(auto const & family : m_entries)
+      {
+      if(!rendered.insert(family.name).second)
+        {
+        continue;
+        }
+
+      output << "# HELP " << family.name << ' ' << family.help << '\n';
+      output << "# TYPE " << family.name << ' ' << family.type << '\n';
+
+      for(auto const & metric : m_entries)
+        {
+        if(metric.name != family.name)
+          {
+          continue;
+          }
+
+        auto const labels = metric.labels.empty() ? std::string{} : "{" + metric.labels + "}";
+        if(metric.counter_metric)
+          {
+          output << metric.name << labels << ' ' << metric.counter_metric->value() << '\n';
+          }
+        else if(metric.histogram_metric)
+          {
+          // Export the power of two bucket boundaries, the finer internal buckets are summed up
+          auto const separator = metric.labels.empty() ? "" : ",";
+          for(auto bound = std::uint64_t{1}; bound < (std::uint64_t{1} << 32); bound <<= 1)
+            {
+            output << metric.name << "_bucket{" << metric.labels << separator << "le=\"" << bound - 1 << "\"} " <<
+                metric.histogram_metric->count_below(bound - 1) << '\n';
+            }
+          output << metric.name << "_bucket{" << metric.labels << separator << "le=\"+Inf\"} " << metric.histogram_metric->count() << '\n';
+          output << metric.name << "_sum" << labels << ' ' << metric.histogram_metric->sum() << '\n';
+          output << metric.name << "_count" << labels << ' ' << metric.histogram_metric->count() << '\n';
+          }
+        else
+          {
+          output << metric.name << labels << ' ' << metric.sample() << '\n';
+          }
+        }
+      }
+
+    return output.str();
+    }
+
+  metrics_registry & metrics()
+    {
+    static metrics_registry registry{};
+    return registry;
+    }
+
+  }
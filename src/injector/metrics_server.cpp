@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/metrics_server.h"
+#include "injector/metrics.h"
+
+#include <boost/asio.hpp>
+using namespace boost;
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * Answer every request on the given acceptor with the current metrics
+     */
+    template<typename Acceptor>
+    void serve(asio::io_service & runLoop, Acceptor & acceptor)
+      {
+      while(true)
+        {
+        typename Acceptor::protocol_type::socket socket{runLoop};
+        acceptor.accept(socket);
+
+        try
+          {
+          // We only ever answer with the metrics, so the request itself is not interesting
+          asio::streambuf request{};
+          asio::read_until(socket, request, "\r\n\r\n");
+
+          auto const body = metrics().render();
+          auto const response = "HTTP/1.0 200 OK\r\n"
+                                "Content-Type: text/plain; version=0.0.4\r\n"
+                                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                "\r\n" + body;
+          asio::write(socket, asio::buffer(response));
+          }
+        catch(std::exception const & error)
+          {
+          std::clog << "Metrics request failed: " << error.what() << std::endl;
+          }
+        }
+      }
+
+    }
+
+  void serve_metrics(std::string const & endpoint)
+    {
+    asio::io_service runLoop{};
+
+    if(endpoint.compare(0, 5, "unix:") == 0)
+      {
+      auto const path = endpoint.substr(5);
+      std::remove(path.c_str());
+      asio::local::stream_protocol::acceptor acceptor{runLoop, asio::local::stream_protocol::endpoint{path}};
+      serve(runLoop, acceptor);
+      }
+    else
+      {
+      auto const separator = endpoint.rfind(':');
+      if(separator == std::string::npos)
+        {
+        throw std::invalid_argument{"metrics endpoint '" + endpoint + "' lacks a port"};
+        }
+
+      auto const address = asio::ip::address::from_string(endpoint.substr(0, separator));
+      auto const port = static_cast<std::uint16_t>(std::stoi(endpoint.substr(separator + 1)));
+      asio::ip::tcp::acceptor acceptor{runLoop, asio::ip::tcp::endpoint{address, port}};
+      serve(runLoop, acceptor);
+      }
+    }
+
+  }
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/output.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <netdb.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace injector
+  {
+
+  fifo_output::fifo_output(std::string const & path, bool truncate)
+    : m_descriptor{open(path.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : O_APPEND) | O_CLOEXEC, 0644)}
+    {
+    if(m_descriptor < 0)
+      {
+      throw std::runtime_error{"cannot open output '" + path + "'"};
+      }
+    }
+
+  fifo_output::~fifo_output()
+    {
+    close(m_descriptor);
+    }
+
+  void fifo_output::write(dab::buffer_chain const & packets)
+    {
+    m_vectors.clear();
+    for(auto const & segment : packets.segments())
+      {
+      m_vectors.push_back(iovec{const_cast<std::uint8_t *>(segment.data), segment.size});
+      }
+
+    auto vector = m_vectors.data();
+    auto remaining = m_vectors.size();
+
+    while(remaining)
+      {
+      auto const written = writev(m_descriptor, vector, static_cast<int>(std::min<std::size_t>(remaining, IOV_MAX)));
+      if(written < 0)
+        {
+        if(errno == EINTR)
+          {
+          continue;
+          }
+
+        throw std::system_error{errno, std::system_category(), "cannot write output"};
+        }
+
+      // Skip what the kernel took, which may end in the middle of a segment
+      auto taken = static_cast<std::size_t>(written);
+      while(remaining && taken >= vector->iov_len)
+        {
+        taken -= vector->iov_len;
+        ++vector;
+        --remaining;
+        }
+
+      if(remaining)
+        {
+        vector->iov_base = static_cast<std::uint8_t *>(vector->iov_base) + taken;
+        vector->iov_len -= taken;
+        }
+      }
+    }
+
+  udp_output::udp_output(std::vector<std::string> const & destinations)
+    {
+    if(destinations.empty())
+      {
+      throw std::invalid_argument{"UDP output requires at least one destination"};
+      }
+
+    m_destinations.resize(destinations.size());
+    m_destination_lengths.resize(destinations.size());
+    for(auto idx = std::size_t{}; idx < destinations.size(); ++idx)
+      {
+      resolve(destinations[idx], m_destinations[idx], m_destination_lengths[idx]);
+      }
+
+    m_socket = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if(m_socket < 0)
+      {
+      throw std::system_error{errno, std::generic_category(), "cannot create UDP output socket"};
+      }
+    }
+
+  udp_output::~udp_output()
+    {
+    close(m_socket);
+    }
+
+  void udp_output::write(dab::buffer_chain const & packets)
+    {
+    m_vectors.clear();
+    if(packets.segments().size() > IOV_MAX)
+      {
+      packets.copy_to(m_block);
+      m_vectors.push_back(iovec{m_block.data(), m_block.size()});
+      }
+    else
+      {
+      for(auto const & segment : packets.segments())
+        {
+        m_vectors.push_back(iovec{const_cast<std::uint8_t *>(segment.data), segment.size});
+        }
+      }
+
+    for(auto idx = std::size_t{}; idx < m_destinations.size(); ++idx)
+      {
+      auto message = msghdr{};
+      message.msg_name = &m_destinations[idx];
+      message.msg_namelen = m_destination_lengths[idx];
+      message.msg_iov = m_vectors.data();
+      message.msg_iovlen = m_vectors.size();
+
+      while(sendmsg(m_socket, &message, 0) < 0)
+        {
+        if(errno != EINTR)
+          {
+          throw std::system_error{errno, std::generic_category(), "cannot send packets"};
+          }
+        }
+      }
+    }
+
+  void resolve(std::string const & destination, sockaddr_storage & address, socklen_t & length)
+    {
+    auto const separator = destination.rfind(':');
+    if(separator == std::string::npos)
+      {
+      throw std::invalid_argument{"destination '" + destination + "' lacks a port"};
+      }
+
+    auto hints = addrinfo{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo * result{};
+    auto const host = destination.substr(0, separator);
+    auto const port = destination.substr(separator + 1);
+    if(getaddrinfo(host.c_str(), port.c_str(), &hints, &result) || !result)
+      {
+      throw std::invalid_argument{"cannot resolve destination '" + destination + "'"};
+      }
+
+    std::memcpy(&address, result->ai_addr, result->ai_addrlen);
+    length = result->ai_addrlen;
+    freeaddrinfo(result);
+    }
+
+  }
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/payload_compressor.h"
+
+#include <time.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * Get the CPU time consumed by the calling thread
+     */
+    std::chrono::nanoseconds thread_cpu_time()
+      {
+      timespec now{};
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+      return std::chrono::seconds{now.tv_sec} + std::chrono::nanoseconds{now.tv_nsec};
+      }
+
+    }
+
+  double compression_statistics_t::ratio() const
+    {
+    return bytes_out ? double(bytes_in) / bytes_out : 0.0;
+    }
+
+  payload_compressor::payload_compressor(int level, std::string dictionary)
+    : m_dictionary{std::move(dictionary)}
+    {
+    if(deflateInit(&m_stream, level) != Z_OK)
+      {
+      throw std::runtime_error{"failed to initialize deflate context"};
+      }
+    }
+
+  payload_compressor::~payload_compressor()
+    {
+    deflateEnd(&m_stream);
+    }
+
+  dab::iobuf payload_compressor::compress(dab::iobuf const & payload)
+    {
+    auto const start = thread_cpu_time();
+
+    deflateReset(&m_stream);
+    if(!m_dictionary.empty())
+      {
+      deflateSetDictionary(&m_stream, reinterpret_cast<Bytef const *>(m_dictionary.data()), m_dictionary.size());
+      }
+
+    auto compressed = dab::iobuf(deflateBound(&m_stream, payload.size()));
+    m_stream.next_in = const_cast<Bytef *>(payload.data());
+    m_stream.avail_in = payload.size();
+    m_stream.next_out = compressed.data();
+    m_stream.avail_out = compressed.size();
+
+    if(deflate(&m_stream, Z_FINISH) != Z_STREAM_END)
+      {
+      throw std::runtime_error{"failed to compress payload"};
+      }
+    compressed.resize(m_stream.total_out);
+
+    ++m_statistics.payloads;
+    m_statistics.bytes_in += payload.size();
+    m_statistics.bytes_out += compressed.size();
+    m_statistics.cpu_time += thread_cpu_time() - start;
+    return compressed;
+    }
+
+  compression_statistics_t const & payload_compressor::statistics() const
+    {
+    return m_statistics;
+    }
+
+  }
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/replay_ingest.h"
+#include "injector/capture_ingest.h"
+#include "injector/trace.h"
+
+#include <tins/sniffer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * The time the pipeline must not write anything for it to be considered drained
+     */
+    auto constexpr kDrainTimeout = std::chrono::milliseconds{500};
+
+    std::uint16_t read_16(std::uint8_t const * data)
+      {
+      return data[0] << 8 | data[1];
+      }
+
+    std::uint64_t total_sent(service_table_t const & table)
+      {
+      auto sent = std::uint64_t{};
+      for(auto const & service : table.services)
+        {
+        sent += service.second->statistics.datagrams_sent.value();
+        }
+      return sent;
+      }
+
+    /**
+     * Wait until the pipeline stopped writing, returning the time of the last write observed
+     */
+    std::chrono::steady_clock::time_point drain(service_directory const & directory)
+      {
+      auto last_write = std::chrono::steady_clock::now();
+      auto sent = total_sent(*directory.current());
+
+      while(std::chrono::steady_clock::now() - last_write < kDrainTimeout)
+        {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+        auto const current = total_sent(*directory.current());
+        if(current != sent)
+          {
+          sent = current;
+          last_write = std::chrono::steady_clock::now();
+          }
+        }
+
+      return last_write;
+      }
+
+    }
+
+  void replay(replay_parameters_t const & parameters, service_directory const & directory, dispatcher & dispatcher)
+    {
+    Tins::FileSniffer sniffer{parameters.file};
+    auto const handle = sniffer.get_pcap_handle();
+    auto const link_type = sniffer.link_type();
+
+    auto const table = directory.current();
+    auto const sent_before = total_sent(*table);
+    auto replayed = std::uint64_t{};
+    auto skipped = std::uint64_t{};
+
+    auto const start = std::chrono::steady_clock::now();
+    auto first = std::chrono::microseconds{-1};
+
+    pcap_pkthdr * header{};
+    u_char const * frame{};
+    while(true)
+      {
+      auto const result = pcap_next_ex(handle, &header, &frame);
+      if(result == -2)
+        {
+        break;
+        }
+      else if(result < 0)
+        {
+        throw std::runtime_error{pcap_geterr(handle)};
+        }
+
+      // Only unfragmented UDP datagrams to one of our services are replayed
+      auto offset = std::size_t{};
+      auto length = std::size_t{};
+      if(!find_ip_datagram(link_type, frame, header->caplen, offset, length))
+        {
+        ++skipped;
+        continue;
+        }
+
+      auto const ip = frame + offset;
+      auto const header_length = std::size_t(ip[0] & 0x0F) * 4;
+      if(ip[9] != 17 || (read_16(ip + 6) & 0x3FFF) || length < header_length + 8 || read_16(ip + header_length + 4) < 8)
+        {
+        ++skipped;
+        continue;
+        }
+
+      auto const udp = ip + header_length;
+      auto const payload_length = std::min<std::size_t>(read_16(udp + 4), length - header_length) - 8;
+      auto const service = table->services.find(read_16(udp + 2));
+      if(service == table->services.end())
+        {
+        ++skipped;
+        continue;
+        }
+
+      // Captures taken on loopback or with GRO may hold payloads no data group can carry
+      if(payload_length > kMaxPayloadSize)
+        {
+        service->second->statistics.oversized.add();
+        ++skipped;
+        continue;
+        }
+
+      // Keep the original spacing of the datagrams, scaled by the requested speed
+      if(parameters.speed > 0)
+        {
+        auto const captured = std::chrono::seconds{header->ts.tv_sec} + std::chrono::microseconds{header->ts.tv_usec};
+        if(first.count() < 0)
+          {
+          first = captured;
+          }
+
+        auto const due = std::chrono::duration_cast<std::chrono::steady_clock::duration>((captured - first) / parameters.speed);
+        std::this_thread::sleep_until(start + due);
+        }
+
+      INJECTOR_TRACE_SCOPE(receive, payload_length);
+
+      auto datagram = queued_datagram_t{};
+      datagram.data.assign(udp + 8, udp + 8 + payload_length);
+      datagram.ingest_time = std::chrono::steady_clock::now();
+      datagram.service = service->second;
+
+      datagram.service->statistics.datagrams_received.add();
+      datagram.service->statistics.bytes_received.add(payload_length);
+      dispatcher.dispatch(std::move(datagram));
+      ++replayed;
+      }
+
+    auto const replayed_at = std::chrono::steady_clock::now();
+    auto const drained_at = drain(directory);
+    auto const written = total_sent(*table) - sent_before;
+
+    auto const seconds = [&](std::chrono::steady_clock::time_point end){
+      return std::chrono::duration<double>(end - start).count();
+    };
+
+    auto report = std::ostringstream{};
+    report << std::fixed << std::setprecision(1) <<
+        "Replayed " << replayed << " datagram(s) from '" << parameters.file << "' in " << seconds(replayed_at) << "s (" <<
+        replayed / seconds(replayed_at) << "/s), skipped " << skipped << " frame(s)\n";
+    report << "Wrote " << written << " datagram(s) in " << seconds(drained_at) << "s, sustaining " <<
+        written / seconds(drained_at) << " datagrams/s\n";
+
+    for(auto const & service : table->services)
+      {
+      auto const & statistics = service.second->statistics;
+      if(!statistics.latency.count())
+        {
+        continue;
+        }
+
+      report << "Service " << service.second->config.name << ": latency p50 " << statistics.latency.quantile(0.5) <<
+          "us p90 " << statistics.latency.quantile(0.9) << "us p99 " << statistics.latency.quantile(0.99) <<
+          "us p99.9 " << statistics.latency.quantile(0.999) << "us max " << statistics.latency.quantile(1) <<
+          "us, dropped " << statistics.expired.value() + statistics.overflow.value() + statistics.oversized.value() << '\n';
+      }
+
+    std::clog << report.str() << std::flush;
+    }
+
+  }
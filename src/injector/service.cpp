@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/service.h"
+
+#include <dab/constants/packet_constants.h>
+
+#include <arpa/inet.h>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace injector
+  {
+
+  service_statistics_t::service_statistics_t(service_configuration_t const & config)
+    : labels{"service=\"" + std::to_string(config.packet_address) + "\""},
+      datagrams_received{metrics().make_counter("dab_injector_datagrams_received_total", "Datagrams received", labels)},
+      bytes_received{metrics().make_counter("dab_injector_bytes_received_total", "Payload bytes received", labels)},
+      datagrams_sent{metrics().make_counter("dab_injector_datagrams_sent_total", "Datagrams written to the output", labels)},
+      bytes_sent{metrics().make_counter("dab_injector_bytes_sent_total", "Packet bytes written to the output", labels)},
+      padding_bytes{metrics().make_counter("dab_injector_padding_bytes_total", "Padding bytes inside the packets written", labels)},
+      expired{metrics().make_counter("dab_injector_dropped_total", "Datagrams dropped before encoding", labels + ",reason=\"expired\"")},
+      overflow{metrics().make_counter("dab_injector_dropped_total", "Datagrams dropped before encoding", labels + ",reason=\"overflow\"")},
+      oversized{metrics().make_counter("dab_injector_dropped_total", "Datagrams dropped before encoding", labels + ",reason=\"oversized\"")},
+      stalls{metrics().make_counter("dab_injector_stream_stalls_total", "Times a stream stopped reading because its service was backed up", labels)},
+      latency{metrics().make_histogram("dab_injector_latency_microseconds", "Time from ingest to output write", labels)}
+    {
+    using namespace dab::internal;
+
+    for(auto idx = std::size_t{}; idx < packets.size(); ++idx)
+      {
+      packets[idx] = &metrics().make_counter("dab_injector_packets_total", "Packets written per packet length",
+          labels + ",length=\"" + std::to_string(constants::kPacketLengths[idx]) + "\"");
+      }
+
+    char const * const stages[] = {"datagram", "data_group", "packet"};
+    for(auto idx = std::size_t{}; idx < encode_time.size(); ++idx)
+      {
+      encode_time[idx] = &metrics().make_counter("dab_injector_encode_nanoseconds_total", "Time spent per encoding stage, including CRCs",
+          labels + ",stage=\"" + stages[idx] + "\"");
+      }
+    }
+
+  namespace
+    {
+
+    std::uint32_t parse_address(std::string const & address)
+      {
+      auto parsed = in_addr{};
+      if(inet_pton(AF_INET, address.c_str(), &parsed) != 1)
+        {
+        throw std::invalid_argument{"invalid IPv4 address '" + address + "'"};
+        }
+      return ntohl(parsed.s_addr);
+      }
+
+    dab::header_context make_context(service_configuration_t const & config)
+      {
+      auto context = dab::header_context{};
+      context.source_address = parse_address(config.source_address);
+      context.destination_address = parse_address(config.destination_address);
+      context.source_port = config.source_port;
+      context.destination_port = config.destination_port;
+      return context;
+      }
+
+    }
+
+  void service_statistics_t::count_packets(dab::buffer_chain const & written)
+    {
+    using namespace dab::internal;
+
+    auto segment = written.segments().begin();
+    auto segment_start = std::size_t{};
+    auto const byte_at = [&](std::size_t index){
+      while(index >= segment_start + segment->size)
+        {
+        segment_start += segment->size;
+        ++segment;
+        }
+      return segment->data[index - segment_start];
+    };
+
+    for(auto idx = std::size_t{}; idx < written.size();)
+      {
+      // The packet length is encoded in the header, followed by the useful data length
+      auto const length_class = byte_at(idx) >> 6;
+      auto const length = constants::kPacketLengths[length_class];
+      auto const useful = byte_at(idx + 2) & 0x7F;
+
+      packets[length_class]->add();
+      padding_bytes.add(length - 5 - useful);
+      idx += length;
+      }
+    }
+
+  service_t::service_t(service_configuration_t const & config)
+    : config{config},
+      datagrams{make_context(config)},
+      packer{config.packet_address},
+      header_compressor{config.header_context_id},
+      statistics{config},
+      time_to_live{config.time_to_live.count()}
+    {
+    if(config.compression_level < 0)
+      {
+      return;
+      }
+
+    auto dictionary = std::string{};
+    if(!config.compression_dictionary.empty())
+      {
+      std::ifstream file{config.compression_dictionary, std::ios::binary};
+      if(!file)
+        {
+        throw std::runtime_error{"cannot read compression dictionary '" + config.compression_dictionary + "'"};
+        }
+      dictionary.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+      }
+
+    compressor.reset(new payload_compressor{config.compression_level, std::move(dictionary)});
+    }
+
+  std::shared_ptr<service_table_t const> make_service_table(configuration_t config, service_table_t const * previous)
+    {
+    auto table = std::make_shared<service_table_t>();
+
+    for(auto const & service : config.services)
+      {
+      auto reused = std::shared_ptr<service_t>{};
+      auto status = previous ? " (new)" : "";
+      if(previous)
+        {
+        auto const existing = previous->services.find(service.port);
+        if(existing != previous->services.end() && existing->second->config == service)
+          {
+          reused = existing->second;
+          reused->time_to_live.store(service.time_to_live.count(), std::memory_order_relaxed);
+          status = " (unchanged)";
+          }
+        else if(existing != previous->services.end() && existing->second->config.name == service.name)
+          {
+          status = " (changed)";
+          }
+        }
+
+      std::clog << "Service " << service.name << ": port " << service.port << " -> " <<
+          service.source_address << ":" << service.source_port << " -> " <<
+          service.destination_address << ":" << service.destination_port <<
+          " packet addr " << service.packet_address <<
+          (service.time_to_live.count() ? " ttl " + std::to_string(service.time_to_live.count()) + "ms" : "") <<
+          (service.compress_headers ? " header context " + std::to_string(service.header_context_id) : "") <<
+          (service.compression_level >= 0 ? " deflate level " + std::to_string(service.compression_level) : "") <<
+          status << std::endl;
+
+      table->services.emplace(service.port, reused ? reused : std::make_shared<service_t>(service));
+      }
+
+    if(previous)
+      {
+      for(auto const & service : previous->services)
+        {
+        auto const replacement = table->services.find(service.first);
+        if(replacement == table->services.end() || replacement->second->config.name != service.second->config.name)
+          {
+          std::clog << "Service " << service.second->config.name << ": removed" << std::endl;
+          }
+        }
+      }
+
+    table->config = std::move(config);
+    return table;
+    }
+
+  service_directory::service_directory(std::shared_ptr<service_table_t const> table)
+    : m_current{std::move(table)}
+    {
+    }
+
+  std::shared_ptr<service_table_t const> service_directory::current() const
+    {
+    return std::atomic_load(&m_current);
+    }
+
+  void service_directory::publish(std::shared_ptr<service_table_t const> table)
+    {
+    std::atomic_store(&m_current, std::move(table));
+    m_generation.fetch_add(1, std::memory_order_release);
+    }
+
+  std::uint64_t service_directory::generation() const
+    {
+    return m_generation.load(std::memory_order_acquire);
+    }
+
+  service_table_cache::service_table_cache(service_directory const & directory)
+    : m_directory{directory},
+      m_generation{directory.generation()},
+      m_table{directory.current()}
+    {
+    }
+
+  service_table_t const & service_table_cache::current()
+    {
+    // Taking the generation before the table at worst reloads a table that was already up to date
+    auto const generation = m_directory.generation();
+    if(generation != m_generation)
+      {
+      m_generation = generation;
+      m_table = m_directory.current();
+      }
+    return *m_table;
+    }
+
+  }
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/shm_ring_reader.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+namespace injector
+  {
+
+  shm_ring_reader::shm_ring_reader(std::string const & name)
+    : m_name{name}
+    {
+    attach();
+    }
+
+  shm_ring_reader::~shm_ring_reader()
+    {
+    munmap(m_header, m_size);
+    }
+
+  bool shm_ring_reader::next(packet_view & view)
+    {
+    auto const published = m_header->write_sequence.load(std::memory_order_acquire);
+    if(published + 1 < m_next || (m_next <= published && published - m_next > m_mask))
+      {
+      resynchronize(published);
+      }
+
+    if(m_next > published)
+      {
+      // A retired ring receives no more packets, so the generation only needs checking once we caught up
+      if(m_header->generation.load(std::memory_order_acquire) != m_generation)
+        {
+        try
+          {
+          attach();
+          }
+        catch(std::exception const &)
+          {
+          // The new ring is not in place yet, keep the old one until the next call
+          return false;
+          }
+        return next(view);
+        }
+      return false;
+      }
+
+    auto const & slot = m_slots[(m_next - 1) & m_mask];
+    auto const sequence = slot.sequence.load(std::memory_order_acquire);
+    if(sequence != m_next)
+      {
+      // The slot is already being reused, we were overrun
+      resynchronize(m_header->write_sequence.load(std::memory_order_acquire));
+      return next(view);
+      }
+
+    view.sequence = sequence;
+    view.data = slot.data;
+    view.length = std::min<std::uint32_t>(slot.length, shm::kSlotPayloadSize);
+    ++m_next;
+    return true;
+    }
+
+  bool shm_ring_reader::valid(packet_view const & view) const
+    {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_slots[(view.sequence - 1) & m_mask].sequence.load(std::memory_order_relaxed) == view.sequence;
+    }
+
+  void shm_ring_reader::wait(std::chrono::milliseconds timeout)
+    {
+    auto const word = m_header->futex_word.load();
+    if(m_next <= m_header->write_sequence.load())
+      {
+      return;
+      }
+
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    auto const delay = timespec{
+      static_cast<time_t>(seconds.count()),
+      static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds).count())
+      };
+
+    m_header->waiters.fetch_add(1);
+    syscall(SYS_futex, &m_header->futex_word, FUTEX_WAIT, word, &delay, nullptr, 0);
+    m_header->waiters.fetch_sub(1);
+    }
+
+  std::uint64_t shm_ring_reader::lost() const
+    {
+    return m_lost;
+    }
+
+  void shm_ring_reader::attach()
+    {
+    auto const descriptor = shm_open(m_name.c_str(), O_RDWR, 0);
+    if(descriptor < 0)
+      {
+      throw std::system_error{errno, std::generic_category(), "cannot open shared memory '" + m_name + "'"};
+      }
+
+    struct stat status{};
+    if(fstat(descriptor, &status) < 0 || std::size_t(status.st_size) < sizeof(shm::ring_header))
+      {
+      close(descriptor);
+      throw std::runtime_error{"shared memory '" + m_name + "' is not a packet ring"};
+      }
+
+    auto const size = std::size_t(status.st_size);
+    auto const memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if(memory == MAP_FAILED)
+      {
+      throw std::system_error{errno, std::generic_category(), "cannot map shared memory '" + m_name + "'"};
+      }
+
+    auto const header = static_cast<shm::ring_header *>(memory);
+    if(header->magic.load(std::memory_order_acquire) != shm::kRingMagic ||
+       header->version != shm::kRingVersion ||
+       shm::ring_size(header->slot_count) > size)
+      {
+      munmap(memory, size);
+      throw std::runtime_error{"shared memory '" + m_name + "' is not a compatible packet ring"};
+      }
+
+    // Let go of the ring we were attached to only once its replacement is usable
+    if(m_header)
+      {
+      munmap(m_header, m_size);
+      }
+
+    m_header = header;
+    m_size = size;
+    m_slots = shm::ring_slots(m_header);
+    m_mask = m_header->slot_count - 1;
+    m_generation = m_header->generation.load(std::memory_order_acquire);
+    m_next = m_header->write_sequence.load(std::memory_order_acquire) + 1;
+    }
+
+  void shm_ring_reader::resynchronize(std::uint64_t published)
+    {
+    if(published + 1 < m_next)
+      {
+      // The writer restarted, its sequence numbers start over
+      m_next = 1;
+      }
+
+    // Skip to the oldest packet that has not yet been overwritten
+    auto const oldest = published > m_mask ? published - m_mask : 1;
+    if(m_next < oldest)
+      {
+      m_lost += oldest - m_next;
+      m_next = oldest;
+      }
+    }
+
+  }
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/shm_ring_writer.h"
+
+#include <dab/constants/packet_constants.h>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    void * map(int descriptor, std::size_t size, std::string const & name)
+      {
+      auto const memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+      if(memory == MAP_FAILED)
+        {
+        auto const error = errno;
+        close(descriptor);
+        throw std::system_error{error, std::generic_category(), "cannot map shared memory '" + name + "'"};
+        }
+      return memory;
+      }
+
+    }
+
+  shm_ring_writer::shm_ring_writer(std::string const & name, std::uint64_t slot_count)
+    : m_mask{slot_count - 1}
+    {
+    if(!slot_count || (slot_count & m_mask))
+      {
+      throw std::invalid_argument{"shared memory ring size must be a power of two"};
+      }
+
+    auto descriptor = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if(descriptor < 0)
+      {
+      throw std::system_error{errno, std::generic_category(), "cannot open shared memory '" + name + "'"};
+      }
+
+    auto const size = shm::ring_size(slot_count);
+    auto generation = std::uint32_t{};
+
+    struct stat status{};
+    if(!fstat(descriptor, &status) && std::size_t(status.st_size) >= sizeof(shm::ring_header))
+      {
+      auto const existing = static_cast<shm::ring_header *>(map(descriptor, sizeof(shm::ring_header), name));
+      auto const ring = existing->magic.load(std::memory_order_acquire) == shm::kRingMagic && existing->version == shm::kRingVersion;
+      auto const compatible = ring && existing->slot_count == slot_count && std::size_t(status.st_size) == size;
+
+      if(ring && !compatible)
+        {
+        // Tell the attached readers to move on to the ring replacing this one
+        generation = existing->generation.load(std::memory_order_relaxed) + 1;
+        existing->generation.store(generation, std::memory_order_release);
+        existing->futex_word.fetch_add(1);
+        syscall(SYS_futex, &existing->futex_word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+      munmap(existing, sizeof(shm::ring_header));
+
+      // Continue where the previous writer left off, so that readers do not even notice the restart
+      if(compatible)
+        {
+        m_header = static_cast<shm::ring_header *>(map(descriptor, size, name));
+        close(descriptor);
+        m_slots = shm::ring_slots(m_header);
+        m_sequence = m_header->write_sequence.load(std::memory_order_acquire);
+        return;
+        }
+      }
+
+    // Readers may still have the old object mapped, so it is replaced rather than resized beneath them
+    if(status.st_size)
+      {
+      close(descriptor);
+      shm_unlink(name.c_str());
+      descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+      if(descriptor < 0)
+        {
+        throw std::system_error{errno, std::generic_category(), "cannot create shared memory '" + name + "'"};
+        }
+      }
+
+    if(ftruncate(descriptor, size) < 0)
+      {
+      auto const error = errno;
+      close(descriptor);
+      throw std::system_error{error, std::generic_category(), "cannot resize shared memory '" + name + "'"};
+      }
+
+    // The object is new and zero filled, readers only attach once the magic is in place, so it is written last
+    m_header = static_cast<shm::ring_header *>(map(descriptor, size, name));
+    close(descriptor);
+    m_header->version = shm::kRingVersion;
+    m_header->slot_count = slot_count;
+    m_header->generation.store(generation, std::memory_order_relaxed);
+    m_slots = shm::ring_slots(m_header);
+    m_header->magic.store(shm::kRingMagic, std::memory_order_release);
+    }
+
+  shm_ring_writer::~shm_ring_writer()
+    {
+    munmap(m_header, shm::ring_size(m_header->slot_count));
+    }
+
+  void shm_ring_writer::write(dab::buffer_chain const & packets)
+    {
+    using namespace dab::internal;
+
+    // Packets span segments, so the block is gathered before it is cut into slots
+    packets.copy_to(m_block);
+    auto data = m_block.data();
+    auto const end = data + m_block.size();
+
+    while(data < end)
+      {
+      // The packet length is encoded in the two most significant bits of the packet header
+      auto const length = constants::kPacketLengths[*data >> 6];
+      if(data + length > end)
+        {
+        throw std::length_error{"incomplete DAB packet"};
+        }
+
+      publish(data, length);
+      data += length;
+      }
+
+    m_header->futex_word.fetch_add(1);
+    if(m_header->waiters.load())
+      {
+      syscall(SYS_futex, &m_header->futex_word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+      }
+    }
+
+  void shm_ring_writer::publish(std::uint8_t const * packet, std::uint32_t length)
+    {
+    auto & slot = m_slots[m_sequence & m_mask];
+    ++m_sequence;
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot.data, packet, length);
+    slot.length = length;
+    slot.sequence.store(m_sequence, std::memory_order_release);
+
+    m_header->write_sequence.store(m_sequence, std::memory_order_release);
+    }
+
+  }
@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/stream_ingest.h"
+#include "injector/trace.h"
+
+#include <boost/asio.hpp>
+using namespace boost;
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * The size of the chunks in which the body of an oversized message is discarded
+     */
+    std::size_t constexpr kDiscardChunkSize{4096};
+
+    /**
+     * A connection to a single producer
+     */
+    template<typename Protocol>
+    struct session : std::enable_shared_from_this<session<Protocol>>
+      {
+      session(asio::io_service & runLoop, typename Protocol::socket socket, std::uint16_t port, service_directory const & directory,
+              dispatcher & dispatcher)
+        : m_runLoop{runLoop},
+          m_socket{std::move(socket)},
+          m_port{port},
+          m_directory{directory},
+          m_dispatcher{dispatcher}
+        {
+        }
+
+      void read_header()
+        {
+        auto self = this->shared_from_this();
+        asio::async_read(m_socket, asio::buffer(m_header), [self](system::error_code const & error, std::size_t){
+          if(!error)
+            {
+            self->read_message();
+            }
+        });
+        }
+
+      private:
+        void read_message()
+          {
+          auto const length = std::uint32_t{m_header[0]} << 24 | std::uint32_t{m_header[1]} << 16 |
+                              std::uint32_t{m_header[2]} << 8 | std::uint32_t{m_header[3]};
+          if(length > kMaxPayloadSize)
+            {
+            auto const table = m_directory.current();
+            auto const service = table->services.find(m_port);
+            if(service != table->services.end())
+              {
+              service->second->statistics.oversized.add();
+              }
+
+            discard(length);
+            return;
+            }
+          else if(!length)
+            {
+            read_header();
+            return;
+            }
+
+          m_pending.data = dab::iobuf(length);
+          auto self = this->shared_from_this();
+          asio::async_read(m_socket, asio::buffer(m_pending.data.data(), length), [self](system::error_code const & error, std::size_t){
+            if(!error)
+              {
+              self->m_pending.ingest_time = std::chrono::steady_clock::now();
+              self->deliver(false);
+              }
+          });
+          }
+
+        void discard(std::size_t remaining)
+          {
+          if(!remaining)
+            {
+            m_scratch.clear();
+            m_scratch.shrink_to_fit();
+            read_header();
+            return;
+            }
+
+          m_scratch.resize(kDiscardChunkSize);
+          auto const chunk = std::min(remaining, kDiscardChunkSize);
+          auto self = this->shared_from_this();
+          asio::async_read(m_socket, asio::buffer(m_scratch.data(), chunk), [self, remaining, chunk](system::error_code const & error, std::size_t){
+            if(!error)
+              {
+              self->discard(remaining - chunk);
+              }
+          });
+          }
+
+        void deliver(bool retried)
+          {
+          INJECTOR_TRACE_SCOPE(receive, m_pending.data.size());
+
+          auto const table = m_directory.current();
+          auto const service = table->services.find(m_port);
+          if(service == table->services.end())
+            {
+            return;
+            }
+
+          if(!retried)
+            {
+            m_pending.service = service->second;
+            m_pending.service->statistics.datagrams_received.add();
+            m_pending.service->statistics.bytes_received.add(m_pending.data.size());
+            }
+
+          if(m_dispatcher.try_dispatch(std::move(m_pending)))
+            {
+            m_pending = queued_datagram_t{};
+            read_header();
+            return;
+            }
+
+          // Stop reading until the queue has room again, the kernel then pushes back on the producer
+          if(!retried)
+            {
+            m_pending.service->statistics.stalls.add();
+            }
+
+          auto self = this->shared_from_this();
+          m_dispatcher.when_room(m_pending, [self]{
+            self->m_runLoop.post([self]{ self->deliver(true); });
+          });
+          }
+
+        asio::io_service & m_runLoop;
+        typename Protocol::socket m_socket;
+        std::uint16_t const m_port;
+        service_directory const & m_directory;
+        dispatcher & m_dispatcher;
+        std::array<std::uint8_t, 4> m_header{};
+        std::vector<std::uint8_t> m_scratch{};
+        queued_datagram_t m_pending{};
+      };
+
+    }
+
+  /**
+   * The acceptor of the stream endpoint of a single service
+   */
+  struct stream_ingest::listener
+    {
+    virtual ~listener() = default;
+
+    virtual void close() = 0;
+
+    std::string endpoint{};
+    };
+
+  namespace
+    {
+
+    template<typename Protocol>
+    struct acceptor_listener : stream_ingest::listener, std::enable_shared_from_this<acceptor_listener<Protocol>>
+      {
+      acceptor_listener(asio::io_service & runLoop, typename Protocol::endpoint const & local, std::uint16_t port,
+                        service_directory const & directory, dispatcher & dispatcher)
+        : m_runLoop{runLoop},
+          m_acceptor{runLoop, local},
+          m_port{port},
+          m_directory{directory},
+          m_dispatcher{dispatcher}
+        {
+        }
+
+      void accept()
+        {
+        auto self = this->shared_from_this();
+        auto client = std::make_shared<typename Protocol::socket>(m_runLoop);
+        m_acceptor.async_accept(*client, [self, client](system::error_code const & error){
+          if(error == asio::error::operation_aborted)
+            {
+            return;
+            }
+
+          if(!error)
+            {
+            std::make_shared<session<Protocol>>(self->m_runLoop, std::move(*client), self->m_port, self->m_directory, self->m_dispatcher)->read_header();
+            }
+
+          self->accept();
+        });
+        }
+
+      void close() override
+        {
+        m_acceptor.close();
+        }
+
+      private:
+        asio::io_service & m_runLoop;
+        typename Protocol::acceptor m_acceptor;
+        std::uint16_t const m_port;
+        service_directory const & m_directory;
+        dispatcher & m_dispatcher;
+      };
+
+    }
+
+  stream_ingest::stream_ingest(asio::io_service & runLoop, service_directory const & directory, dispatcher & dispatcher)
+    : m_runLoop{runLoop},
+      m_directory{directory},
+      m_dispatcher{dispatcher}
+    {
+    }
+
+  stream_ingest::~stream_ingest() = default;
+
+  void stream_ingest::update()
+    {
+    auto const table = m_directory.current();
+
+    for(auto listener = m_listeners.begin(); listener != m_listeners.end();)
+      {
+      auto const service = table->services.find(listener->first);
+      if(service != table->services.end() && service->second->config.stream == listener->second->endpoint)
+        {
+        ++listener;
+        continue;
+        }
+
+      listener->second->close();
+      listener = m_listeners.erase(listener);
+      }
+
+    for(auto const & service : table->services)
+      {
+      auto const & config = service.second->config;
+      if(config.stream.empty() || m_listeners.count(service.first))
+        {
+        continue;
+        }
+
+      try
+        {
+        auto created = std::shared_ptr<listener>{};
+        if(config.stream.compare(0, 5, "unix:") == 0)
+          {
+          auto const path = config.stream.substr(5);
+          struct stat existing;
+          if(!lstat(path.c_str(), &existing))
+            {
+            if(!S_ISSOCK(existing.st_mode))
+              {
+              throw std::invalid_argument{"'" + path + "' exists and is not a socket"};
+              }
+
+            std::remove(path.c_str());
+            }
+          auto local = std::make_shared<acceptor_listener<asio::local::stream_protocol>>(m_runLoop,
+              asio::local::stream_protocol::endpoint{path}, service.first, m_directory, m_dispatcher);
+          local->accept();
+          created = local;
+          }
+        else
+          {
+          auto const separator = config.stream.rfind(':');
+          if(separator == std::string::npos)
+            {
+            throw std::invalid_argument{"stream endpoint '" + config.stream + "' lacks a port"};
+            }
+
+          auto const address = asio::ip::address::from_string(config.stream.substr(0, separator));
+          auto const port = static_cast<std::uint16_t>(std::stoi(config.stream.substr(separator + 1)));
+          auto tcp = std::make_shared<acceptor_listener<asio::ip::tcp>>(m_runLoop,
+              asio::ip::tcp::endpoint{address, port}, service.first, m_directory, m_dispatcher);
+          tcp->accept();
+          created = tcp;
+          }
+
+        created->endpoint = config.stream;
+        m_listeners.emplace(service.first, created);
+        }
+      catch(std::exception const & error)
+        {
+        std::cerr << "Error: cannot accept streams for service " << config.name << ": " << error.what() << '\n';
+        }
+      }
+    }
+
+  }
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/subchannel_stream.h"
+
+#include <dab/constants/packet_constants.h>
+#include <dab/util/crc16.h>
+#include <dab/util/vector_helpers.h>
+
+#include <algorithm>
+
+namespace injector
+  {
+
+  using namespace dab::internal;
+
+  subchannel_stream::subchannel_stream(std::size_t capacity, counter & dropped)
+    : m_capacity{capacity},
+      m_dropped{dropped}
+    {
+    // A padding packet has address 0 and carries no useful data
+    m_padding_packet = dab::byte_vector_t(constants::kPacketLengths[0] - 2);
+    m_padding_packet[0] = 0x0C;
+    concat_vectors_inplace(m_padding_packet, genCRC16(m_padding_packet));
+    }
+
+  void subchannel_stream::append(dab::buffer_chain const & packets)
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+
+    // Blocks are dropped as a whole, so that the stream keeps consisting of complete packets
+    if(m_pending.size() + packets.size() > m_capacity)
+      {
+      m_dropped.add();
+      return;
+      }
+
+    for(auto const & segment : packets.segments())
+      {
+      m_pending.insert(m_pending.end(), segment.data, segment.data + segment.size);
+      }
+    }
+
+  void subchannel_stream::take(std::uint8_t * frame, std::size_t size)
+    {
+    auto length = std::size_t{};
+
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    length = std::min(size, m_pending.size());
+    std::copy(m_pending.begin(), m_pending.begin() + length, frame);
+    m_pending.erase(m_pending.begin(), m_pending.begin() + length);
+    }
+
+    // All packet lengths are multiples of the padding packet length, so the frame ends on a packet boundary
+    for(; length < size; length += m_padding_packet.size())
+      {
+      std::copy(m_padding_packet.begin(), m_padding_packet.end(), frame + length);
+      }
+    }
+
+  }
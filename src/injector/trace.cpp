@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/trace.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace injector
+  {
+
+  namespace trace
+    {
+
+    namespace
+      {
+
+      char const * const kEventNames[] = {"receive", "compress", "serialize", "data_group", "packet", "output"};
+
+      std::mutex & rings_mutex()
+        {
+        static std::mutex mutex{};
+        return mutex;
+        }
+
+      /**
+       * All rings ever created, they are kept alive after their thread exits so that they can still be dumped
+       */
+      std::vector<std::shared_ptr<ring>> & rings()
+        {
+        static std::vector<std::shared_ptr<ring>> all{};
+        return all;
+        }
+
+      ring & thread_ring()
+        {
+        thread_local auto const own = []{
+          auto created = std::make_shared<ring>();
+          created->head = 0;
+
+          auto lock = std::unique_lock<std::mutex>{rings_mutex()};
+          created->thread = rings().size();
+          rings().push_back(created);
+          return created;
+        }();
+        return *own;
+        }
+
+      std::atomic<bool> dump_requested{false};
+
+      void request_dump(int)
+        {
+        dump_requested = true;
+        }
+
+      }
+
+    std::uint64_t now()
+      {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+    void emit(event id, std::uint64_t start, std::uint64_t duration, std::uint32_t arg)
+      {
+      auto & own = thread_ring();
+      auto const head = own.head.load(std::memory_order_relaxed);
+      own.records[head % kRingCapacity] = record{start, duration, arg, id};
+      own.head.store(head + 1, std::memory_order_release);
+      }
+
+    std::string dump_chrome_json()
+      {
+      auto snapshot = std::vector<std::shared_ptr<ring>>{};
+      {
+      auto lock = std::unique_lock<std::mutex>{rings_mutex()};
+      snapshot = rings();
+      }
+
+      auto json = std::ostringstream{};
+      json << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+      auto separator = "";
+
+      for(auto const & source : snapshot)
+        {
+        auto const head = source->head.load(std::memory_order_acquire);
+        auto const first = head > kRingCapacity ? head - kRingCapacity : 0;
+        auto copy = std::vector<record>{};
+        copy.reserve(head - first);
+        for(auto idx = first; idx < head; ++idx)
+          {
+          copy.push_back(source->records[idx % kRingCapacity]);
+          }
+
+        // The owner kept writing while we copied, drop everything it may have overwritten. It fills the slot
+        // of the next record before publishing it, so that slot may be torn as well.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto const overwritten = source->head.load(std::memory_order_relaxed);
+        auto const valid = overwritten + 1 > kRingCapacity ? overwritten + 1 - kRingCapacity : 0;
+
+        for(auto idx = first; idx < head; ++idx)
+          {
+          if(idx < valid)
+            {
+            continue;
+            }
+
+          auto const & entry = copy[idx - first];
+          json << separator << "{\"name\":\"" << kEventNames[static_cast<std::size_t>(entry.id)] << "\",\"ph\":\"X\",\"pid\":" << getpid() <<
+              ",\"tid\":" << source->thread << ",\"ts\":" << entry.start / 1000.0 << ",\"dur\":" << entry.duration / 1000.0 <<
+              ",\"args\":{\"arg\":" << entry.arg << "}}";
+          separator = ",";
+          }
+        }
+
+      json << "]}";
+      return json.str();
+      }
+
+    void dump_on_signal(int signal)
+      {
+      std::signal(signal, request_dump);
+
+      std::thread{[]{
+        for(auto dump = 0u;; )
+          {
+          std::this_thread::sleep_for(std::chrono::milliseconds{100});
+          if(!dump_requested.exchange(false))
+            {
+            continue;
+            }
+
+          auto const path = "/tmp/data-injector-" + std::to_string(getpid()) + "-" + std::to_string(dump++) + ".json";
+          std::ofstream{path} << dump_chrome_json();
+          std::clog << "Wrote trace to " << path << std::endl;
+          }
+      }}.detach();
+      }
+
+    }
+
+  }
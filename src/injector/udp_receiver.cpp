@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/udp_receiver.h"
+#include "injector/trace.h"
+#include "injector/uring_receiver.h"
+
+#include <boost/asio.hpp>
+using namespace boost;
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    /**
+     * A receiver running on an ASIO io_service
+     */
+    struct asio_receiver : udp_receiver
+      {
+      asio_receiver(std::size_t index, std::size_t count, service_directory const & directory, dispatcher & dispatcher)
+        : m_index{index},
+          m_count{count},
+          m_directory{directory},
+          m_services{directory},
+          m_dispatcher{dispatcher}
+        {
+        }
+
+      void update() override
+        {
+        m_runLoop.post([this]{ synchronize(); });
+        }
+
+      void run() override
+        {
+        m_runLoop.run();
+        }
+
+      private:
+        struct listener_t
+          {
+          listener_t(asio::io_service & runLoop, service_configuration_t const & config, bool shared)
+            : port{config.port},
+              group{config.group},
+              interface{config.interface},
+              socket{runLoop, asio::ip::udp::v4(), open_udp_socket(config, shared)}
+            {
+            }
+
+          std::uint16_t const port;
+          std::string const group;
+          std::string const interface;
+          asio::ip::udp::socket socket;
+          asio::ip::udp::endpoint remote{};
+          // One byte more than fits into a data group, so that a longer datagram is told apart from one that just fits
+          std::array<char, kMaxPayloadSize + 1> buffer{};
+          };
+
+        void synchronize()
+          {
+          auto const table = m_directory.current();
+
+          for(auto listener = m_listeners.begin(); listener != m_listeners.end();)
+            {
+            auto const service = table->services.find(listener->first);
+            if(service != table->services.end() && service->second->config.group == listener->second->group &&
+               service->second->config.interface == listener->second->interface)
+              {
+              ++listener;
+              continue;
+              }
+
+            listener->second->socket.close();
+            listener = m_listeners.erase(listener);
+            }
+
+          for(auto const & service : table->services)
+            {
+            auto const & config = service.second->config;
+            if(m_listeners.count(service.first) || !receives(config, m_index, m_count))
+              {
+              continue;
+              }
+
+            try
+              {
+              auto listener = std::make_shared<listener_t>(m_runLoop, config, m_count > 1);
+              m_listeners.emplace(service.first, listener);
+              receive(listener);
+              }
+            catch(std::exception const & error)
+              {
+              std::cerr << "Error: cannot receive service " << config.name << ": " << error.what() << '\n';
+              }
+            }
+          }
+
+        void receive(std::shared_ptr<listener_t> listener)
+          {
+          listener->socket.async_receive_from(asio::buffer(listener->buffer), listener->remote,
+              [this, listener](system::error_code const & error, std::size_t length){
+            if(error == asio::error::operation_aborted)
+              {
+              return;
+              }
+
+            if(!error)
+              {
+              dispatch(*listener, length);
+              }
+
+            receive(listener);
+          });
+          }
+
+        void dispatch(listener_t const & listener, std::size_t length)
+          {
+          INJECTOR_TRACE_SCOPE(receive, length);
+
+          auto const & table = m_services.current();
+          auto const service = table.services.find(listener.port);
+          if(service == table.services.end())
+            {
+            return;
+            }
+
+          auto & statistics = service->second->statistics;
+          statistics.datagrams_received.add();
+          statistics.bytes_received.add(length);
+
+          // The datagram was truncated to the buffer, or does not fit into a data group anyway
+          if(length > kMaxPayloadSize)
+            {
+            statistics.oversized.add();
+            return;
+            }
+
+          auto datagram = queued_datagram_t{};
+          datagram.data.assign(listener.buffer.data(), listener.buffer.data() + length);
+          datagram.ingest_time = std::chrono::steady_clock::now();
+          datagram.service = service->second;
+          m_dispatcher.dispatch(std::move(datagram));
+          }
+
+        std::size_t const m_index;
+        std::size_t const m_count;
+        service_directory const & m_directory;
+        service_table_cache m_services;
+        dispatcher & m_dispatcher;
+        asio::io_service m_runLoop{};
+        asio::io_service::work m_work{m_runLoop};
+        std::map<std::uint16_t, std::shared_ptr<listener_t>> m_listeners{};
+      };
+
+    void check(int result, char const * what)
+      {
+      if(result < 0)
+        {
+        throw std::system_error{errno, std::system_category(), what};
+        }
+      }
+
+    }
+
+  bool receives(service_configuration_t const & service, std::size_t index, std::size_t count)
+    {
+    return service.group.empty() || service.port % count == index;
+    }
+
+  int open_udp_socket(service_configuration_t const & service, bool shared)
+    {
+    auto const socket = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    check(socket, "socket");
+
+    try
+      {
+      auto const enable = 1;
+      if(shared)
+        {
+        check(setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)), "SO_REUSEPORT");
+        }
+
+      if(!service.group.empty())
+        {
+        check(setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)), "SO_REUSEADDR");
+        }
+
+      auto local = sockaddr_in{};
+      local.sin_family = AF_INET;
+      local.sin_port = htons(service.port);
+      local.sin_addr.s_addr = htonl(INADDR_ANY);
+      check(bind(socket, reinterpret_cast<sockaddr const *>(&local), sizeof(local)), "bind");
+
+      if(!service.group.empty())
+        {
+        auto membership = ip_mreq{};
+        if(inet_pton(AF_INET, service.group.c_str(), &membership.imr_multiaddr) != 1)
+          {
+          throw std::invalid_argument{"invalid multicast group '" + service.group + "'"};
+          }
+
+        if(service.interface.empty())
+          {
+          membership.imr_interface.s_addr = htonl(INADDR_ANY);
+          }
+        else if(inet_pton(AF_INET, service.interface.c_str(), &membership.imr_interface) != 1)
+          {
+          throw std::invalid_argument{"invalid interface address '" + service.interface + "'"};
+          }
+
+        check(setsockopt(socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)), "IP_ADD_MEMBERSHIP");
+        }
+      }
+    catch(...)
+      {
+      close(socket);
+      throw;
+      }
+
+    return socket;
+    }
+
+  std::unique_ptr<udp_receiver> make_udp_receiver(std::string const & backend, std::size_t index, std::size_t count,
+                                                  service_directory const & directory, dispatcher & dispatcher)
+    {
+    if(backend == "uring")
+      {
+      if(uring_available())
+        {
+        return std::unique_ptr<udp_receiver>{new uring_receiver{index, count, directory, dispatcher}};
+        }
+
+      if(!index)
+        {
+        std::clog << "io_uring is not available, falling back to asio" << std::endl;
+        }
+      }
+    else if(backend != "asio")
+      {
+      throw std::invalid_argument{"unknown input backend '" + backend + "'"};
+      }
+
+    return std::unique_ptr<udp_receiver>{new asio_receiver{index, count, directory, dispatcher}};
+    }
+
+  }
@@ -0,0 +1,570 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "injector/uring_receiver.h"
+#include "injector/trace.h"
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+namespace injector
+  {
+
+  namespace
+    {
+
+    auto constexpr kSubmissionEntries = 256u;
+    auto constexpr kCompletionEntries = 4096u;
+    auto constexpr kBufferCount = 512u;
+    // Larger than any payload fitting into a data group, so that a longer datagram is told apart from one that just fits
+    auto constexpr kBufferSize = 8192u;
+
+    static_assert(kBufferSize > kMaxPayloadSize, "receive buffers must detect oversized datagrams");
+    auto constexpr kBufferGroup = 0u;
+
+    auto constexpr kWakeupId = std::uint64_t{0};
+    auto constexpr kCancelId = std::numeric_limits<std::uint64_t>::max();
+
+    std::atomic<std::uint64_t> g_enter_calls{};
+
+    void check(long result, char const * what)
+      {
+      if(result < 0)
+        {
+        throw std::system_error{errno, std::system_category(), what};
+        }
+      }
+
+    template<typename ValueType>
+    ValueType load_acquire(ValueType const * value)
+      {
+      return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+      }
+
+    template<typename ValueType>
+    void store_release(ValueType * value, ValueType update)
+      {
+      __atomic_store_n(value, update, __ATOMIC_RELEASE);
+      }
+
+    template<typename PointerType>
+    PointerType * at(void * base, std::uint32_t offset)
+      {
+      return reinterpret_cast<PointerType *>(static_cast<char *>(base) + offset);
+      }
+
+    }
+
+  /**
+   * The submission and completion rings, along with the buffer ring the receives are served from
+   */
+  struct uring_receiver::ring
+    {
+    ring()
+      {
+      auto parameters = io_uring_params{};
+      parameters.flags = IORING_SETUP_CQSIZE;
+      parameters.cq_entries = kCompletionEntries;
+
+      m_fd = static_cast<int>(syscall(__NR_io_uring_setup, kSubmissionEntries, &parameters));
+      check(m_fd, "io_uring_setup");
+
+      try
+        {
+        map(parameters);
+        provide_buffers();
+        }
+      catch(...)
+        {
+        release();
+        throw;
+        }
+      }
+
+    ~ring()
+      {
+      release();
+      }
+
+    ring(ring const &) = delete;
+    ring & operator=(ring const &) = delete;
+
+    /**
+     * Take the next free submission queue entry, submitting the pending ones if the queue is full
+     */
+    io_uring_sqe & next()
+      {
+      auto const tail = *m_sq_tail;
+      if(tail - load_acquire(m_sq_head) == m_sq_entries)
+        {
+        enter(0);
+        }
+
+      auto const index = tail & m_sq_mask;
+      auto & entry = m_sqes[index];
+      std::memset(&entry, 0, sizeof(entry));
+      m_sq_array[index] = index;
+      store_release(m_sq_tail, tail + 1);
+      ++m_pending;
+      return entry;
+      }
+
+    /**
+     * Submit the pending entries and wait for the given number of completions
+     */
+    void enter(unsigned wait)
+      {
+      for(;;)
+        {
+        g_enter_calls.fetch_add(1, std::memory_order_relaxed);
+        auto const result = syscall(__NR_io_uring_enter, m_fd, m_pending, wait, wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+        if(result >= 0)
+          {
+          m_pending -= static_cast<unsigned>(result);
+          return;
+          }
+
+        if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+          {
+          throw std::system_error{errno, std::system_category(), "io_uring_enter"};
+          }
+
+        if(errno != EINTR)
+          {
+          wait = 0;
+          }
+        }
+      }
+
+    /**
+     * Hand all available completions to the handler
+     */
+    template<typename Handler>
+    void reap(Handler && handler)
+      {
+      auto head = *m_cq_head;
+      while(head != load_acquire(m_cq_tail))
+        {
+        auto const entry = m_cqes[head & m_cq_mask];
+        store_release(m_cq_head, ++head);
+        handler(entry.user_data, entry.res, entry.flags);
+        }
+      }
+
+    /**
+     * The buffer with the given id
+     */
+    char const * buffer(std::uint16_t id) const
+      {
+      return m_buffers + std::size_t{id} * kBufferSize;
+      }
+
+    /**
+     * Return a buffer to the kernel
+     */
+    void recycle(std::uint16_t id)
+      {
+      auto & entry = m_buffer_ring[m_buffer_tail & (kBufferCount - 1)];
+      entry.addr = reinterpret_cast<std::uintptr_t>(buffer(id));
+      entry.len = kBufferSize;
+      entry.bid = id;
+      store_release(&m_buffer_ring[0].resv, ++m_buffer_tail);
+      }
+
+    private:
+      void map(io_uring_params const & parameters)
+        {
+        m_sq_size = parameters.sq_off.array + parameters.sq_entries * sizeof(std::uint32_t);
+        m_cq_size = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+        if(parameters.features & IORING_FEAT_SINGLE_MMAP)
+          {
+          m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+          }
+
+        m_sq = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+        if(m_sq == MAP_FAILED)
+          {
+          m_sq = nullptr;
+          check(-1, "mmap");
+          }
+
+        if(parameters.features & IORING_FEAT_SINGLE_MMAP)
+          {
+          m_cq = m_sq;
+          }
+        else
+          {
+          m_cq = mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+          if(m_cq == MAP_FAILED)
+            {
+            m_cq = nullptr;
+            check(-1, "mmap");
+            }
+          }
+
+        m_sqes_size = parameters.sq_entries * sizeof(io_uring_sqe);
+        auto const sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+        if(sqes == MAP_FAILED)
+          {
+          check(-1, "mmap");
+          }
+
+        m_sqes = static_cast<io_uring_sqe *>(sqes);
+        m_sq_entries = parameters.sq_entries;
+        m_sq_head = at<std::uint32_t>(m_sq, parameters.sq_off.head);
+        m_sq_tail = at<std::uint32_t>(m_sq, parameters.sq_off.tail);
+        m_sq_mask = *at<std::uint32_t>(m_sq, parameters.sq_off.ring_mask);
+        m_sq_array = at<std::uint32_t>(m_sq, parameters.sq_off.array);
+        m_cq_head = at<std::uint32_t>(m_cq, parameters.cq_off.head);
+        m_cq_tail = at<std::uint32_t>(m_cq, parameters.cq_off.tail);
+        m_cq_mask = *at<std::uint32_t>(m_cq, parameters.cq_off.ring_mask);
+        m_cqes = at<io_uring_cqe>(m_cq, parameters.cq_off.cqes);
+        }
+
+      void provide_buffers()
+        {
+        auto const memory = mmap(nullptr, kRingSize + kBufferCount * kBufferSize, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(memory == MAP_FAILED)
+          {
+          check(-1, "mmap");
+          }
+
+        // The ring is addressed as an array of io_uring_buf, with the tail overlaying the reserved field of the
+        // first entry. The flexible array of io_uring_buf_ring is misplaced when the header is compiled as C++.
+        m_buffer_ring = static_cast<io_uring_buf *>(memory);
+        m_buffers = static_cast<char *>(memory) + kRingSize;
+
+        auto registration = io_uring_buf_reg{};
+        registration.ring_addr = reinterpret_cast<std::uintptr_t>(m_buffer_ring);
+        registration.ring_entries = kBufferCount;
+        registration.bgid = kBufferGroup;
+        check(syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PBUF_RING, &registration, 1), "IORING_REGISTER_PBUF_RING");
+
+        for(auto id = 0u; id < kBufferCount; ++id)
+          {
+          recycle(static_cast<std::uint16_t>(id));
+          }
+        }
+
+      void release()
+        {
+        if(m_buffer_ring)
+          {
+          munmap(m_buffer_ring, kRingSize + kBufferCount * kBufferSize);
+          }
+
+        if(m_sqes)
+          {
+          munmap(m_sqes, m_sqes_size);
+          }
+
+        if(m_cq && m_cq != m_sq)
+          {
+          munmap(m_cq, m_cq_size);
+          }
+
+        if(m_sq)
+          {
+          munmap(m_sq, m_sq_size);
+          }
+
+        close(m_fd);
+        }
+
+      static auto constexpr kRingSize = std::size_t{kBufferCount * sizeof(io_uring_buf)};
+
+      int m_fd{-1};
+      void * m_sq{};
+      void * m_cq{};
+      std::size_t m_sq_size{};
+      std::size_t m_cq_size{};
+      std::size_t m_sqes_size{};
+      io_uring_sqe * m_sqes{};
+      std::uint32_t m_sq_entries{};
+      std::uint32_t * m_sq_head{};
+      std::uint32_t * m_sq_tail{};
+      std::uint32_t m_sq_mask{};
+      std::uint32_t * m_sq_array{};
+      std::uint32_t * m_cq_head{};
+      std::uint32_t * m_cq_tail{};
+      std::uint32_t m_cq_mask{};
+      io_uring_cqe * m_cqes{};
+      unsigned m_pending{};
+      io_uring_buf * m_buffer_ring{};
+      char * m_buffers{};
+      std::uint16_t m_buffer_tail{};
+    };
+
+  /**
+   * A socket with its multishot receive
+   */
+  struct uring_receiver::listener
+    {
+    std::uint64_t id;
+    int socket;
+    std::string group;
+    std::string interface;
+    };
+
+  bool uring_available()
+    {
+    static auto const available = []{
+      auto system = utsname{};
+      auto major = 0;
+      auto minor = 0;
+      if(uname(&system) || std::sscanf(system.release, "%d.%d", &major, &minor) != 2 || major < 6)
+        {
+        return false;
+        }
+
+      try
+        {
+        uring_receiver::ring probe{};
+        return true;
+        }
+      catch(std::system_error const &)
+        {
+        return false;
+        }
+    }();
+
+    return available;
+    }
+
+  std::uint64_t uring_enter_calls()
+    {
+    return g_enter_calls.load(std::memory_order_relaxed);
+    }
+
+  uring_receiver::uring_receiver(std::size_t index, std::size_t count, service_directory const & directory, dispatcher & dispatcher)
+    : m_index{index},
+      m_count{count},
+      m_directory{directory},
+      m_services{directory},
+      m_dispatcher{dispatcher},
+      m_ring{new ring{}},
+      m_listeners{},
+      m_wakeup{eventfd(0, EFD_CLOEXEC)}
+    {
+    check(m_wakeup, "eventfd");
+    }
+
+  uring_receiver::~uring_receiver()
+    {
+    for(auto const & listener : m_listeners)
+      {
+      close(listener.second->socket);
+      }
+
+    close(m_wakeup);
+    }
+
+  void uring_receiver::update()
+    {
+    auto const signal = std::uint64_t{1};
+    if(write(m_wakeup, &signal, sizeof(signal)) < 0)
+      {
+      std::cerr << "Error: cannot wake up receiver: " << std::strerror(errno) << '\n';
+      }
+    }
+
+  void uring_receiver::run()
+    {
+    arm_wakeup();
+
+    for(;;)
+      {
+      m_ring->enter(1);
+      m_ring->reap([this](std::uint64_t id, std::int32_t result, std::uint32_t flags){
+        complete(id, result, flags);
+      });
+      }
+    }
+
+  void uring_receiver::synchronize()
+    {
+    auto const table = m_directory.current();
+    auto cancelled = false;
+
+    for(auto listener = m_listeners.begin(); listener != m_listeners.end();)
+      {
+      auto const service = table->services.find(listener->first);
+      if(service != table->services.end() && service->second->config.group == listener->second->group &&
+         service->second->config.interface == listener->second->interface)
+        {
+        ++listener;
+        continue;
+        }
+
+      auto & cancel = m_ring->next();
+      cancel.opcode = IORING_OP_ASYNC_CANCEL;
+      cancel.addr = listener->second->id;
+      cancel.user_data = kCancelId;
+      close(listener->second->socket);
+      listener = m_listeners.erase(listener);
+      cancelled = true;
+      }
+
+    if(cancelled)
+      {
+      m_ring->enter(0);
+      }
+
+    for(auto const & service : table->services)
+      {
+      auto const & config = service.second->config;
+      if(m_listeners.count(service.first) || !receives(config, m_index, m_count))
+        {
+        continue;
+        }
+
+      try
+        {
+        auto created = std::unique_ptr<listener>{new listener{}};
+        created->id = (m_next_id++ << 16) | service.first;
+        created->socket = open_udp_socket(config, m_count > 1);
+        created->group = config.group;
+        created->interface = config.interface;
+        arm_receive(*created);
+        m_listeners.emplace(service.first, std::move(created));
+        }
+      catch(std::exception const & error)
+        {
+        std::cerr << "Error: cannot receive service " << config.name << ": " << error.what() << '\n';
+        }
+      }
+    }
+
+  void uring_receiver::arm_wakeup()
+    {
+    auto & read = m_ring->next();
+    read.opcode = IORING_OP_READ;
+    read.fd = m_wakeup;
+    read.addr = reinterpret_cast<std::uintptr_t>(&m_wakeup_value);
+    read.len = sizeof(m_wakeup_value);
+    read.user_data = kWakeupId;
+    }
+
+  void uring_receiver::arm_receive(listener const & listener)
+    {
+    auto & receive = m_ring->next();
+    receive.opcode = IORING_OP_RECV;
+    receive.fd = listener.socket;
+    receive.ioprio = IORING_RECV_MULTISHOT;
+    receive.flags = IOSQE_BUFFER_SELECT;
+    receive.buf_group = kBufferGroup;
+    receive.user_data = listener.id;
+    }
+
+  void uring_receiver::complete(std::uint64_t id, std::int32_t result, std::uint32_t flags)
+    {
+    if(id == kCancelId)
+      {
+      return;
+      }
+
+    if(id == kWakeupId)
+      {
+      synchronize();
+      arm_wakeup();
+      return;
+      }
+
+    auto const port = static_cast<std::uint16_t>(id & 0xffff);
+    auto const listener = m_listeners.find(port);
+    auto const current = listener != m_listeners.end() && listener->second->id == id;
+
+    if(flags & IORING_CQE_F_BUFFER)
+      {
+      auto const buffer = static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+      if(current && result > 0)
+        {
+        INJECTOR_TRACE_SCOPE(receive, result);
+
+        auto const & table = m_services.current();
+        auto const service = table.services.find(port);
+        if(service != table.services.end())
+          {
+          auto & statistics = service->second->statistics;
+          statistics.datagrams_received.add();
+          statistics.bytes_received.add(result);
+
+          // The datagram was truncated to the buffer, or does not fit into a data group anyway
+          if(std::size_t(result) > kMaxPayloadSize)
+            {
+            statistics.oversized.add();
+            }
+          else
+            {
+            auto datagram = queued_datagram_t{};
+            auto const data = m_ring->buffer(buffer);
+            datagram.data.assign(data, data + result);
+            datagram.ingest_time = std::chrono::steady_clock::now();
+            datagram.service = service->second;
+            m_dispatcher.dispatch(std::move(datagram));
+            }
+          }
+        }
+
+      m_ring->recycle(buffer);
+      }
+
+    if(!current || (flags & IORING_CQE_F_MORE))
+      {
+      return;
+      }
+
+    if(result >= 0 || result == -ENOBUFS)
+      {
+      arm_receive(*listener->second);
+      return;
+      }
+
+    std::cerr << "Error: cannot receive on port " << port << ": " << std::strerror(-result) << '\n';
+    close(listener->second->socket);
+    m_listeners.erase(listener);
+    }
+
+  }
@@ -31,12 +31,12 @@
 
 #include "dab/msc_data_group/msc_data_group_generator.h"
 #include "dab/util/crc16.h"
-#include "dab/util/vector_helpers.h"
 #include "dab/constants/msc_data_group_constants.h"
 
 #include <dab/types/common_types.h>
 #include <dab/literals/binary_literal.h>
 
+#include <algorithm>
 #include <bitset>
 
 namespace dab
@@ -44,9 +44,8 @@ namespace dab
 
   using namespace internal;
 
-  byte_vector_t msc_data_group_generator::build_header()
+  void msc_data_group_generator::build_header(std::uint8_t * header)
     {
-    auto header = byte_vector_t(2);
     header[0]  = 0 << 7;  //Extension flag
     header[0] |= 1 << 6;  //CRC flag
     header[0] |= 0 << 5;  //Segmentation flag
@@ -54,12 +53,20 @@ namespace dab
     header[1]  = constants::kDataGroupTypes[0];    //Data group type
     header[1] |= m_continuity_index << 4; //Continuity index
     header[1] |= m_repetition_index;      //Repetition index
-    return header;
     }
 
   byte_vector_t msc_data_group_generator::build(byte_vector_t & ip_datagram)
     {
-    if(ip_datagram != m_last_ip_datagram)
+    auto group = iobuf{};
+    group.assign(ip_datagram.begin(), ip_datagram.end());
+    build(group);
+    return byte_vector_t{group.begin(), group.end()};
+    }
+
+  void msc_data_group_generator::build(iobuf & ip_datagram)
+    {
+    if(ip_datagram.size() != m_last_ip_datagram.size() ||
+       !std::equal(ip_datagram.begin(), ip_datagram.end(), m_last_ip_datagram.begin()))
       {
       m_continuity_index = (m_continuity_index + 1) % 16;
       m_repetition_index = 0;
@@ -68,11 +75,11 @@ namespace dab
       {
       m_repetition_index > 0 ? m_repetition_index-- : m_repetition_index = 0;
       }
-    m_last_ip_datagram = ip_datagram;
-    auto header = build_header();
-    concat_vectors_inplace(header, ip_datagram);
-    auto crc = genCRC16(header);
-    concat_vectors_inplace(header, crc);
-    return header;
+    m_last_ip_datagram.assign(ip_datagram.begin(), ip_datagram.end());
+    build_header(ip_datagram.prepend(2));
+    auto const crc = static_cast<std::uint16_t>(~updateCRC16(0xFFFF, ip_datagram.data(), ip_datagram.size()));
+    auto const trailer = ip_datagram.append(2);
+    trailer[0] = crc >> 8;
+    trailer[1] = crc;
     }
   }
@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/modulation/ofdm_modulator.h"
+#include "dab/modulation/frequency_interleaver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace dab
+  {
+
+  using namespace internal;
+
+  namespace
+    {
+
+    /**
+     * Four floats processed together, which the compiler maps onto SSE or NEON registers
+     */
+    typedef float lanes_t __attribute__((vector_size(16), __may_alias__));
+
+    std::size_t constexpr kLanes {sizeof(lanes_t) / sizeof(float)};
+
+    /**
+     * The phase increments in multiples of pi/4 of the QPSK symbols, indexed by their two bits
+     */
+    std::uint8_t constexpr kQPSKPhases[] {1, 7, 3, 5};
+
+    /**
+     * The parameter h of the phase reference symbol, table 44 of EN 300 401
+     */
+    std::uint8_t constexpr kPhaseReferenceH[4][32] {
+      {0, 2, 0, 0, 0, 0, 1, 1, 2, 0, 0, 0, 2, 2, 1, 1, 0, 2, 0, 0, 0, 0, 1, 1, 2, 0, 0, 0, 2, 2, 1, 1},
+      {0, 3, 2, 3, 0, 1, 3, 0, 2, 1, 2, 3, 2, 3, 3, 0, 0, 3, 2, 3, 0, 1, 3, 0, 2, 1, 2, 3, 2, 3, 3, 0},
+      {0, 0, 0, 2, 0, 2, 1, 3, 2, 2, 0, 2, 2, 0, 1, 3, 0, 0, 0, 2, 0, 2, 1, 3, 2, 2, 0, 2, 2, 0, 1, 3},
+      {0, 1, 2, 1, 0, 3, 3, 2, 2, 3, 2, 1, 2, 1, 3, 2, 0, 1, 2, 1, 0, 3, 3, 2, 2, 3, 2, 1, 2, 1, 3, 2},
+    };
+
+    /**
+     * A run of 32 carriers of the phase reference symbol, starting at carrier first, using row i of h and offset n
+     */
+    struct phase_reference_run
+      {
+      std::int16_t first;
+      std::uint8_t i;
+      std::uint8_t n;
+      };
+
+    /**
+     * The phase reference runs of modes I to IV, tables 40 to 43 of EN 300 401
+     */
+    phase_reference_run constexpr kPhaseReferenceMode1[] {
+      {-768, 0, 1}, {-736, 1, 2}, {-704, 2, 0}, {-672, 3, 1}, {-640, 0, 3}, {-608, 1, 2}, {-576, 2, 2}, {-544, 3, 3},
+      {-512, 0, 2}, {-480, 1, 1}, {-448, 2, 2}, {-416, 3, 3}, {-384, 0, 1}, {-352, 1, 2}, {-320, 2, 3}, {-288, 3, 3},
+      {-256, 0, 2}, {-224, 1, 2}, {-192, 2, 2}, {-160, 3, 1}, {-128, 0, 1}, {-96, 1, 3}, {-64, 2, 1}, {-32, 3, 2},
+      {1, 0, 3}, {33, 3, 1}, {65, 2, 1}, {97, 1, 1}, {129, 0, 2}, {161, 3, 2}, {193, 2, 1}, {225, 1, 0},
+      {257, 0, 2}, {289, 3, 2}, {321, 2, 3}, {353, 1, 3}, {385, 0, 0}, {417, 3, 2}, {449, 2, 1}, {481, 1, 3},
+      {513, 0, 3}, {545, 3, 3}, {577, 2, 3}, {609, 1, 0}, {641, 0, 3}, {673, 3, 0}, {705, 2, 1}, {737, 1, 1},
+    };
+
+    phase_reference_run constexpr kPhaseReferenceMode2[] {
+      {-192, 0, 2}, {-160, 1, 3}, {-128, 2, 2}, {-96, 3, 2}, {-64, 0, 1}, {-32, 1, 2},
+      {1, 2, 0}, {33, 1, 2}, {65, 0, 2}, {97, 3, 1}, {129, 2, 0}, {161, 1, 3},
+    };
+
+    phase_reference_run constexpr kPhaseReferenceMode3[] {
+      {-96, 0, 2}, {-64, 1, 3}, {-32, 2, 0}, {1, 3, 2}, {33, 2, 2}, {65, 1, 2},
+    };
+
+    phase_reference_run constexpr kPhaseReferenceMode4[] {
+      {-384, 0, 0}, {-352, 1, 1}, {-320, 2, 1}, {-288, 3, 2}, {-256, 0, 2}, {-224, 1, 2}, {-192, 2, 0}, {-160, 3, 3},
+      {-128, 0, 3}, {-96, 1, 1}, {-64, 2, 3}, {-32, 3, 2}, {1, 0, 0}, {33, 3, 1}, {65, 2, 0}, {97, 1, 2},
+      {129, 0, 0}, {161, 3, 1}, {193, 2, 2}, {225, 1, 2}, {257, 0, 2}, {289, 3, 1}, {321, 2, 3}, {353, 1, 0},
+    };
+
+    /**
+     * The phase of every FFT bin in the phase reference symbol, in multiples of pi/4
+     */
+    std::vector<std::uint8_t> phase_reference(types::transmission_mode const & mode)
+      {
+      auto runs = static_cast<phase_reference_run const *>(nullptr);
+      auto count = std::size_t{};
+      switch(mode.id)
+        {
+        case 1:
+          runs = kPhaseReferenceMode1;
+          count = sizeof(kPhaseReferenceMode1) / sizeof(*kPhaseReferenceMode1);
+          break;
+        case 2:
+          runs = kPhaseReferenceMode2;
+          count = sizeof(kPhaseReferenceMode2) / sizeof(*kPhaseReferenceMode2);
+          break;
+        case 3:
+          runs = kPhaseReferenceMode3;
+          count = sizeof(kPhaseReferenceMode3) / sizeof(*kPhaseReferenceMode3);
+          break;
+        case 4:
+          runs = kPhaseReferenceMode4;
+          count = sizeof(kPhaseReferenceMode4) / sizeof(*kPhaseReferenceMode4);
+          break;
+        default:
+          throw std::invalid_argument{"unknown transmission mode " + std::to_string(mode.id)};
+        }
+
+      auto phases = std::vector<std::uint8_t>(mode.fft_length);
+      for(auto run = runs; run != runs + count; ++run)
+        {
+        for(auto offset = 0; offset < 32; ++offset)
+          {
+          auto const bin = (run->first + offset + mode.fft_length) % mode.fft_length;
+          phases[bin] = 2 * (kPhaseReferenceH[run->i][offset] + run->n) % 8;
+          }
+        }
+      return phases;
+      }
+
+    std::size_t reverse_bits(std::size_t value, std::size_t size)
+      {
+      auto reversed = std::size_t{};
+      for(auto bit = std::size_t{1}; bit < size; bit <<= 1)
+        {
+        reversed = reversed << 1 | (value & 1);
+        value >>= 1;
+        }
+      return reversed;
+      }
+
+    }
+
+  ofdm_modulator::ofdm_modulator(types::transmission_mode const & mode)
+    : m_mode{mode},
+      m_phases(mode.carriers),
+      m_real(mode.fft_length * kLanes),
+      m_imag(mode.fft_length * kLanes),
+      m_samples(mode.frame_duration)
+    {
+    auto const reference = phase_reference(mode);
+    auto const interleaver = internal::frequency_interleaver{mode};
+
+    // The transform takes its input in bit reversed order, so the carriers are placed there right away
+    for(auto const bin : interleaver.table())
+      {
+      m_reference.push_back(reference[bin]);
+      m_bins.push_back(reverse_bits(bin, mode.fft_length));
+      }
+
+    auto const pi = std::acos(-1.0);
+    auto const scale = 1 / std::sqrt(static_cast<double>(mode.carriers));
+    for(auto phase = 0; phase < 8; ++phase)
+      {
+      m_constellation.push_back(sample_t(std::polar(scale, pi / 4 * phase)));
+      }
+
+    for(auto idx = std::size_t{}; idx < mode.fft_length / 2u; ++idx)
+      {
+      m_twiddles.push_back(sample_t(std::polar(1.0, 2 * pi * idx / mode.fft_length)));
+      }
+    }
+
+  std::size_t ofdm_modulator::frame_size() const
+    {
+    return std::size_t{m_mode.frame_symbols} * m_mode.symbol_bits / 8;
+    }
+
+  void ofdm_modulator::modulate(std::uint8_t const * bits, sample_queue_t & samples)
+    {
+    // The null symbol at the start of the frame stays zero, the phase reference symbol comes first
+    auto const symbols = std::size_t{m_mode.frame_symbols} + 1;
+    for(auto first = std::size_t{}; first < symbols; first += kLanes)
+      {
+      std::fill(m_real.begin(), m_real.end(), 0.0f);
+      std::fill(m_imag.begin(), m_imag.end(), 0.0f);
+
+      auto const lanes = std::min(kLanes, symbols - first);
+      for(auto lane = std::size_t{}; lane < lanes; ++lane)
+        {
+        load(first + lane, lane, bits);
+        }
+
+      transform();
+
+      for(auto lane = std::size_t{}; lane < lanes; ++lane)
+        {
+        store(first + lane, lane);
+        }
+      }
+
+    samples.enqueue(m_samples);
+    }
+
+  void ofdm_modulator::load(std::size_t symbol, std::size_t lane, std::uint8_t const * bits)
+    {
+    auto const carriers = m_phases.size();
+    if(!symbol)
+      {
+      std::copy(m_reference.begin(), m_reference.end(), m_phases.begin());
+      }
+    else
+      {
+      // Carrier n is modulated with bits n and n + K of the symbol
+      auto const first = bits + (symbol - 1) * m_mode.symbol_bits / 8;
+      auto const second = first + carriers / 8;
+      for(auto carrier = std::size_t{}; carrier < carriers; ++carrier)
+        {
+        auto const shift = 7 - carrier % 8;
+        auto const index = (first[carrier / 8] >> shift & 1) << 1 | (second[carrier / 8] >> shift & 1);
+        m_phases[carrier] = (m_phases[carrier] + kQPSKPhases[index]) % 8;
+        }
+      }
+
+    for(auto carrier = std::size_t{}; carrier < carriers; ++carrier)
+      {
+      auto const value = m_constellation[m_phases[carrier]];
+      m_real[m_bins[carrier] * kLanes + lane] = value.real();
+      m_imag[m_bins[carrier] * kLanes + lane] = value.imag();
+      }
+    }
+
+  void ofdm_modulator::transform()
+    {
+    auto const real = reinterpret_cast<lanes_t *>(m_real.data());
+    auto const imag = reinterpret_cast<lanes_t *>(m_imag.data());
+    auto const size = std::size_t{m_mode.fft_length};
+
+    // Radix 2 decimation in time, each butterfly multiplying all lanes by the same twiddle factor
+    for(auto half = std::size_t{1}; half < size; half *= 2)
+      {
+      auto const stride = size / (2 * half);
+      for(auto group = std::size_t{}; group < size; group += 2 * half)
+        {
+        for(auto idx = std::size_t{}; idx < half; ++idx)
+          {
+          auto const twiddle = m_twiddles[idx * stride];
+          auto const top = group + idx;
+          auto const bottom = top + half;
+
+          lanes_t const product_real = real[bottom] * twiddle.real() - imag[bottom] * twiddle.imag();
+          lanes_t const product_imag = real[bottom] * twiddle.imag() + imag[bottom] * twiddle.real();
+          real[bottom] = real[top] - product_real;
+          imag[bottom] = imag[top] - product_imag;
+          real[top] += product_real;
+          imag[top] += product_imag;
+          }
+        }
+      }
+    }
+
+  void ofdm_modulator::store(std::size_t symbol, std::size_t lane)
+    {
+    auto const size = std::size_t{m_mode.fft_length};
+    auto const guard = std::size_t{m_mode.guard_duration};
+    auto output = m_samples.data() + m_mode.null_duration + symbol * (guard + size);
+
+    // The guard interval repeats the end of the symbol
+    for(auto sample = size - guard; sample < size; ++sample)
+      {
+      *output++ = sample_t{m_real[sample * kLanes + lane], m_imag[sample * kLanes + lane]};
+      }
+
+    for(auto sample = std::size_t{}; sample < size; ++sample)
+      {
+      *output++ = sample_t{m_real[sample * kLanes + lane], m_imag[sample * kLanes + lane]};
+      }
+    }
+
+  }
@@ -32,74 +32,243 @@
 #include <boost/asio.hpp>
 using namespace boost;
 
-#include <tins/ip.h>
-#include <tins/udp.h>
-#include <tins/rawpdu.h>
+#include <dab/types/pool_allocator.h>
 
-#include <array>
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#include <dab/msc_data_group/msc_data_group_generator.h>
-#include <dab/packet/packet_generator.h>
+#include <injector/capture_ingest.h>
+#include <injector/configuration.h>
+#include <injector/dispatch.h>
+#include <injector/edi_output.h>
+#include <injector/eti_output.h>
+#include <injector/fanout_output.h>
+#include <injector/metrics.h>
+#include <injector/metrics_server.h>
+#include <injector/output.h>
+#include <injector/replay_ingest.h>
+#include <injector/service.h>
+#include <injector/shm_ring_writer.h>
+#include <injector/stream_ingest.h>
+#include <injector/trace.h>
+#include <injector/udp_receiver.h>
 
-#include "INIReader.h"
+/**
+ * @since 1.1.0
+ *
+ * Measure the time spent on a task and add it to the given counter
+ */
+template<typename Task>
+auto timed(injector::counter & total, Task && task) -> decltype(task())
+  {
+  // Stops the clock when the task returns, which also covers tasks without a result
+  struct stopwatch
+    {
+    ~stopwatch()
+      {
+      total.add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+      }
+
+    injector::counter & total;
+    std::chrono::steady_clock::time_point const start;
+    } const watch{total, std::chrono::steady_clock::now()};
+
+  return task();
+  }
 
 /**
- * @author Felix Morgner
- * @since 1.0
+ * @since 1.1.0
+ *
+ * Check whether a queued datagram has outlived the time to live of its service, counting it as dropped if so
  *
- * A simple structure to hold our configuration
+ * @param datagram The datagram to check
  */
-struct configuration_t
+bool is_expired(injector::queued_datagram_t const & datagram)
   {
-  /**
-   * The DAB packet address for our packets
-   */
-  std::uint16_t packet_address{1000};
-
-  /**
-   * The IP destination address of the packed data
-   */
-  std::string destination_address{"10.0.0.1"};
-
-  /**
-   * The UDP destination port of the packed data
-   */
-  std::uint16_t destination_port{4242};
-
-  /**
-   * The IP source address of the packed data
-   */
-  std::string source_address{"10.0.0.2"};
-
-  /**
-   * The UDP source port of the packed data
-   */
-  std::uint16_t source_port{1337};
-  };
+  auto & service = *datagram.service;
+  auto const time_to_live = std::chrono::milliseconds{service.time_to_live.load(std::memory_order_relaxed)};
+  if(time_to_live == std::chrono::milliseconds::zero() || std::chrono::steady_clock::now() - datagram.ingest_time <= time_to_live)
+    {
+    return false;
+    }
+
+  service.statistics.expired.add();
+  ++service.statistics.expired_unreported;
+  return true;
+  }
 
 /**
- * @author Felix Morgner
- * @since 1.0
+ * @since 1.1.0
  *
- * Receive data from the remote endpoint via UDP
+ * Compress the payloads of the services using compression before handing them to the packager
  *
- * @param runLoop The ASIO io_service to run on
- * @param port The port to listen on for data
+ * Every compressor runs on a worker thread of its own, so that the time spent compressing never delays the
+ * datagrams that are already waiting for the packager. The services are sharded across the compressors, so
+ * that the deflate stream and dictionary of a service are only ever used by a single thread. Deflate may grow
+ * incompressible payloads, those no longer fitting into a data group are dropped and counted as oversized.
+ *
+ * @param queue The queue to take the uncompressed datagrams of the services of this compressor from
+ * @param dispatcher The dispatcher to hand the compressed datagrams to
+ * @param directory The directory to find the services to report on in
  */
-std::string receive(asio::io_service & runLoop, std::uint16_t port)
+void compress(injector::compression_queue & queue, injector::dispatcher & dispatcher, injector::service_directory const & directory)
   {
-  // Set up ASIO to receive data via UDP
-  asio::ip::udp::socket socket{runLoop, asio::ip::udp::endpoint{asio::ip::udp::v4(), port}};
-  asio::ip::udp::endpoint remote{};
+  auto constexpr kReportInterval = std::chrono::seconds{60};
+
+  auto datagram = injector::queued_datagram_t{};
+  auto last_report = std::chrono::steady_clock::now();
+
+  while(true)
+    {
+    queue.dequeue(datagram);
+
+    // Stale datagrams are dropped before spending any time on deflating them
+    if(is_expired(datagram))
+      {
+      continue;
+      }
+
+    {
+    INJECTOR_TRACE_SCOPE(compress, datagram.data.size());
+    datagram.data = datagram.service->compressor->compress(datagram.data);
+    }
+
+    if(datagram.data.size() > injector::kMaxPayloadSize)
+      {
+      datagram.service->statistics.oversized.add();
+      continue;
+      }
+
+    // Wait for the packager rather than throwing away the work already done, the receivers drop instead
+    dispatcher.package(std::move(datagram));
+
+    auto const now = std::chrono::steady_clock::now();
+    if(now - last_report >= kReportInterval)
+      {
+      for(auto const & service : directory.current()->services)
+        {
+        if(!service.second->compressor || &dispatcher.compressor_of(*service.second) != &queue)
+          {
+          continue;
+          }
 
-  // The buffer for the incoming data
-  std::array<char, 1024> buffer{};
+        auto const & statistics = service.second->compressor->statistics();
+        std::clog << "Service " << service.second->config.name << ": compressed " << statistics.payloads <<
+            " payload(s) at ratio " << statistics.ratio() << " using " <<
+            std::chrono::duration_cast<std::chrono::microseconds>(statistics.cpu_time).count() << "us CPU time" << std::endl;
+        }
+      last_report = now;
+      }
+    }
+  }
 
-  // Receive data from a remote endpoint
-  auto length = socket.receive_from(asio::buffer(buffer), remote);
-  return {buffer.data(), length};
+/**
+ * @since 1.1.0
+ *
+ * Run a task on a detached thread, terminating the injector if it fails
+ *
+ * @param task The task to run
+ */
+void run_detached(std::function<void()> task)
+  {
+  std::thread{[task]{
+    try
+      {
+      task();
+      }
+    catch(std::exception const & error)
+      {
+      std::cerr << "Error: " << error.what() << '\n';
+      std::exit(EXIT_FAILURE);
+      }
+  }}.detach();
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Report the datagrams of a service dropped since the last report, if any
+ *
+ * @param service The service to report on
+ */
+void report_expired(injector::service_t & service)
+  {
+  auto & statistics = service.statistics;
+  if(!statistics.expired_unreported.load(std::memory_order_relaxed))
+    {
+    return;
+    }
+
+  std::clog << "Service " << service.config.name << ": dropped " << statistics.expired_unreported.exchange(0) <<
+      " expired datagram(s), " << statistics.expired.value() << " in total" << std::endl;
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Re-read the configuration and publish the resulting service table
+ *
+ * The new table is built on the calling thread, so that neither ingest nor packaging stall while
+ * dictionaries are read or metrics are registered. Only opening and closing sockets happens on the
+ * run loop. If the new configuration is invalid, the current one stays in effect.
+ *
+ * @param file The configuration file to read
+ * @param directory The directory to publish the new table in
+ * @param apply Called once the new table is published, to open and close the sockets of the ingest paths
+ */
+void reload(std::string const & file, injector::service_directory & directory, std::function<void()> const & apply)
+  {
+  std::clog << "Reloading configuration from '" << file << "'" << std::endl;
+
+  try
+    {
+    auto config = injector::read_configuration(file);
+    auto const previous = directory.current();
+
+    auto const & current = previous->config;
+    if(config.outputs != current.outputs || config.metrics_endpoint != current.metrics_endpoint ||
+       config.receivers != current.receivers || config.packagers != current.packagers ||
+       config.compressors != current.compressors || config.queue_size != current.queue_size ||
+       config.input_backend != current.input_backend)
+      {
+      std::clog << "Changes to the input, output and metrics settings take effect after a restart" << std::endl;
+      }
+
+    directory.publish(injector::make_service_table(std::move(config), previous.get()));
+    apply();
+    }
+  catch(std::exception const & error)
+    {
+    std::cerr << "Error: " << error.what() << ", keeping the current configuration\n";
+    }
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Call the given function every time a signal of the set is received
+ */
+void on_signal(asio::signal_set & signals, std::function<void()> handler)
+  {
+  signals.async_wait([&signals, handler](system::error_code const & error, int){
+    if(!error)
+      {
+      handler();
+      on_signal(signals, handler);
+      }
+  });
   }
 
 /**
@@ -108,66 +277,242 @@ std::string receive(asio::io_service & runLoop, std::uint16_t port)
  *
  * Wrap and split the received data into DAB packet mode packets
  *
- * @param data The data to wrap and split
- * @param config The configuration to use
+ * @param received The received data to wrap and split
  */
-std::string wrap_data(std::string const & data, configuration_t const & config)
+dab::buffer_chain wrap_data(injector::queued_datagram_t & received)
   {
-  // Prepare our DAB packaging objects
-  static auto grouper = dab::msc_data_group_generator{};
-  static auto packer = dab::packet_generator{config.packet_address};
+  auto data = std::move(received.data);
+  auto & service = *received.service;
+  auto const & config = service.config;
+  auto & statistics = service.statistics;
 
-  // Repackage the received data into a new IP datagram
-  auto datagram = (
-    Tins::IP{config.destination_address, config.source_address} /
-    Tins::UDP{config.destination_port, config.source_port} /
-    Tins::RawPDU{data}
-    ).serialize();
+  // Repackage the received data into a new IP datagram, or a compressed one if the receiver knows our context.
+  // Captured datagrams are complete already and go straight to the data group generator. The headers are
+  // written into the headroom of the received buffer, so the payload is never copied.
+  timed(*statistics.encode_time[0], [&]{
+    INJECTOR_TRACE_SCOPE(serialize, data.size());
+    if(received.raw)
+      {
+      return;
+      }
+    else if(config.compress_headers)
+      {
+      service.header_compressor.build(data);
+      }
+    else
+      {
+      service.datagrams.build(data);
+      }
+  });
 
   // Wrap the newly created datagram into MSC data groups and split it into packets
-  auto group = grouper.build(datagram);
-  auto split = packer.build(group);
-  return {reinterpret_cast<char const *>(split.data()), split.size()};
+  timed(*statistics.encode_time[1], [&]{
+    INJECTOR_TRACE_SCOPE(data_group, data.size());
+    service.grouper.build(data);
+  });
+  return timed(*statistics.encode_time[2], [&]{
+    INJECTOR_TRACE_SCOPE(packet, data.size());
+    return service.packer.build(std::move(data));
+  });
   }
 
-int main() try
+/**
+ * @since 1.1.0
+ *
+ * Open the output described by the given configuration
+ *
+ * @param truncate Whether a file or ETI output empties an existing file, only ever set for the first open
+ */
+std::unique_ptr<injector::output> open_output(injector::output_configuration_t const & config, bool truncate)
   {
-  // The UDP port our daemon is listening at
-  std::uint16_t constexpr UDP_PORT{4321};
+  if(config.type == "fifo" || config.type == "file")
+    {
+    return std::unique_ptr<injector::output>{new injector::fifo_output{config.path, truncate}};
+    }
+  else if(config.type == "udp")
+    {
+    return std::unique_ptr<injector::output>{new injector::udp_output{config.destinations}};
+    }
+  else if(config.type == "shm")
+    {
+    return std::unique_ptr<injector::output>{new injector::shm_ring_writer{config.path, config.slots}};
+    }
+  else if(config.type == "edi")
+    {
+    return std::unique_ptr<injector::output>{new injector::edi_output{config.edi, injector::output_dropped(config.name)}};
+    }
+  else if(config.type == "eti")
+    {
+    return std::unique_ptr<injector::output>{new injector::eti_output{config.path, truncate, config.edi, injector::output_dropped(config.name)}};
+    }
 
+  throw std::invalid_argument{"unknown output type '" + config.type + "'"};
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Package the datagrams of the services assigned to a packager thread and write them to the output
+ *
+ * @param queue The queue to take the datagrams from
+ * @param output The outputs to write the packets to
+ */
+void package(injector::packager_queue & queue, injector::fanout_output & output)
+  {
+  injector::queued_datagram_t datagram{};
+
+  while(true)
+    {
+    queue.dequeue(datagram);
+    auto & service = *datagram.service;
 
-  const char *configuration_file = "injector.ini";
-  INIReader ini(configuration_file);
-  int line_err = ini.ParseError();
+    // Stale datagrams are dropped without ever being encoded
+    if(is_expired(datagram))
+      {
+      if(!queue.approximate_size())
+        {
+        report_expired(service);
+        }
+      continue;
+      }
+
+    report_expired(service);
+    // The block is shared by the queues of all outputs, its buffers are released after the last write
+    auto const packets = std::allocate_shared<dab::buffer_chain>(dab::internal::pool_allocator<dab::buffer_chain>{}, wrap_data(datagram));
+    {
+    INJECTOR_TRACE_SCOPE(output, packets->size());
+    output.write(packets);
+    }
 
-  if (line_err) {
-      std::cerr << "Error, cannot read configuration file '" << configuration_file << "'" << std::endl;
-      std::cerr << "At line:       " << line_err << std::endl;
-      return 1;
+    auto & statistics = service.statistics;
+    statistics.datagrams_sent.add();
+    statistics.bytes_sent.add(packets->size());
+    statistics.count_packets(*packets);
+    statistics.latency.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - datagram.ingest_time).count());
+    }
   }
-  configuration_t conf;
-  conf.source_address      = ini.Get("source.address", conf.source_address);
-  conf.source_port         = ini.GetInteger("source.port", conf.source_port);
-  conf.destination_address = ini.Get("destination.address", conf.destination_address);
-  conf.destination_port    = ini.GetInteger("destination.port", conf.destination_port);
-  conf.packet_address      = ini.GetInteger("packet.address", conf.packet_address);
 
-  std::clog << "Loaded configuration: " <<
-      conf.source_address << ":" << conf.source_port << " -> " <<
-      conf.destination_address << ":" << conf.destination_port <<
-      " packet addr " << conf.packet_address << std::endl;
+int main() try
+  {
+  auto const configuration_file = std::string{"injector.ini"};
+  auto conf = injector::read_configuration(configuration_file);
 
-  // The ASIO io_service we want to run network I/O operations on
-  asio::io_service runLoop{};
+  std::clog << "Loaded configuration: receivers " << conf.receivers << " (" << conf.input_backend << ") packagers " << conf.packagers <<
+      " compressors " << conf.compressors << " outputs";
+  for(auto const & output : conf.outputs)
+    {
+    std::clog << ' ' << output.name << '=' << output.type << ':' << (output.destinations.empty() ? output.path : output.destinations.front());
+    }
+  std::clog << std::endl;
 
-  // The FIFO to write the data to
-  std::ofstream fifo{"/tmp/dabdata", std::ios::binary};
+  // The services, replaced as a whole when the configuration is reloaded
+  injector::service_directory directory{injector::make_service_table(conf)};
 
-  // Our main run loop
-  while(true)
+  // The queues between the receivers, the compressors and the packagers
+  injector::dispatcher dispatcher{conf.packagers, conf.queue_size, conf.compressors};
+
+  for(auto const & queue : dispatcher.compression_queues())
+    {
+    auto const target = queue.get();
+    run_detached([target, &dispatcher, &directory]{ compress(*target, dispatcher, directory); });
+    }
+
+  for(auto idx = std::size_t{}; idx < dispatcher.packager_queues().size(); ++idx)
+    {
+    auto const queue = dispatcher.packager_queues()[idx].get();
+    injector::metrics().make_gauge("dab_injector_queue_depth", "Datagrams waiting in a queue", "queue=\"packager\",index=\"" + std::to_string(idx) + "\"",
+        [queue]{ return queue->approximate_size(); });
+    }
+  for(auto idx = std::size_t{}; idx < dispatcher.compression_queues().size(); ++idx)
+    {
+    auto const queue = dispatcher.compression_queues()[idx].get();
+    injector::metrics().make_gauge("dab_injector_queue_depth", "Datagrams waiting in a queue", "queue=\"compressor\",index=\"" + std::to_string(idx) + "\"",
+        [queue]{ return queue->approximate_size(); });
+    }
+  injector::metrics().make_gauge("dab_injector_buffer_system_allocations", "Blocks the buffer pool took from the system allocator, constant once warmed up", "",
+      []{ return dab::internal::pool::system_allocations(); });
+
+  if(!conf.metrics_endpoint.empty())
+    {
+    run_detached([&]{ injector::serve_metrics(conf.metrics_endpoint); });
+    }
+
+#if defined(INJECTOR_TRACING)
+  injector::trace::dump_on_signal(SIGUSR1);
+  std::clog << "Tracing enabled, send SIGUSR1 to dump the trace" << std::endl;
+#endif
+
+  // Receive on separate threads, so that datagrams are stamped on arrival even while we are busy packaging
+  auto receivers = std::vector<std::unique_ptr<injector::udp_receiver>>{};
+  for(auto idx = std::size_t{}; idx < conf.receivers; ++idx)
     {
-    fifo << wrap_data(receive(runLoop, UDP_PORT), conf) << std::flush;
+    receivers.push_back(injector::make_udp_receiver(conf.input_backend, idx, conf.receivers, directory, dispatcher));
+    receivers.back()->update();
     }
+
+  // Streams from producers that need reliable delivery are served on a run loop of their own
+  asio::io_service stream_loop{};
+  injector::stream_ingest streams{stream_loop, directory, dispatcher};
+  streams.update();
+
+  // Datagrams captured from network interfaces are read on threads of their own
+  injector::capture_ingest captures{directory, dispatcher};
+  captures.update();
+
+  for(auto const & receiver : receivers)
+    {
+    auto const target = receiver.get();
+    run_detached([target]{ target->run(); });
+    }
+  run_detached([&]{
+    asio::io_service::work work{stream_loop};
+    stream_loop.run();
+  });
+
+  // Reload the configuration on SIGHUP, on a thread of its own so that neither ingest nor packaging stall
+  asio::io_service control{};
+  asio::signal_set hangups{control, SIGHUP};
+  on_signal(hangups, [&]{
+    reload(configuration_file, directory, [&]{
+      for(auto const & receiver : receivers)
+        {
+        receiver->update();
+        }
+      stream_loop.post([&streams]{ streams.update(); });
+      captures.update();
+    });
+  });
+  run_detached([&]{ control.run(); });
+
+  // The FIFOs, files, sockets and shared-memory rings to write the data to, each written on a thread of its own.
+  // A FIFO losing its reader fails the write to that output instead of ending the injector.
+  std::signal(SIGPIPE, SIG_IGN);
+  injector::fanout_output output{};
+  for(auto const & config : conf.outputs)
+    {
+    auto const first = std::make_shared<std::atomic<bool>>(true);
+    output.add(config.name, [config, first]{ return open_output(config, config.truncate && first->exchange(false)); }, config.queue_size);
+    }
+
+  // Package on as many threads as configured, the last one being our main thread
+  auto const & queues = dispatcher.packager_queues();
+  for(auto idx = std::size_t{1}; idx < queues.size(); ++idx)
+    {
+    auto const queue = queues[idx].get();
+    run_detached([queue, &output]{ package(*queue, output); });
+    }
+
+  // A replay feeds the pipeline once everything is in place, and ends the injector after its report
+  if(!conf.replay.file.empty())
+    {
+    run_detached([&]{
+      injector::replay(conf.replay, directory, dispatcher);
+      std::exit(EXIT_SUCCESS);
+    });
+    }
+
+  package(*queues[0], output);
   }
 catch(std::exception const & error)
   {
@@ -30,7 +30,6 @@
  */
 
 #include "dab/util/crc16.h"
-#include "dab/util/vector_helpers.h"
 #include "dab/packet/packet_generator.h"
 #include "dab/constants/packet_constants.h"
 
@@ -38,6 +37,7 @@
 #include <dab/literals/binary_literal.h>
 
 #include <cstdint>
+#include <utility>
 
 namespace dab
   {
@@ -45,17 +45,43 @@ namespace dab
   using namespace internal;
   using namespace literals;
 
-  packet_generator::packet_generator(std::uint16_t address) : kAddress{address}
+  packet_generator::packet_generator(std::uint16_t address)
+    : kAddress{address},
+      kHeaderPatterns{{
+        packet_encoder<0>::pattern(address),
+        packet_encoder<1>::pattern(address),
+        packet_encoder<2>::pattern(address),
+        packet_encoder<3>::pattern(address),
+      }}
     {
     }
 
   byte_vector_t packet_generator::build(byte_vector_t & msc_data_group)
     {
-    auto len = msc_data_group.size();
+    auto group = iobuf{};
+    group.assign(msc_data_group.begin(), msc_data_group.end());
+    auto packets = byte_vector_t{};
+    build(std::move(group)).copy_to(packets);
+    return packets;
+    }
+
+  buffer_chain packet_generator::build(iobuf && msc_data_group)
+    {
+    auto const full = packet_encoder<3>::kDataLength;
+    auto remaining = msc_data_group.size();
+    auto const count = remaining > full ? (remaining - 1) / full + 1 : 1;
+
+    // Header and CRC of consecutive packets are adjacent, so each CRC merges with the next header
+    auto overhead = iobuf(count * 5, 0, 0);
+    auto header = overhead.data();
+    auto data = msc_data_group.data();
 
-    if(len > constants::kPacketDataLengths[3])
+    auto packets = buffer_chain{};
+    packets.hold(std::move(msc_data_group));
+    packets.hold(std::move(overhead));
+
+    while(remaining > full)
       {
-      auto packet_length = constants::kPacketDataLengths[3];
       if(m_first_last == 01_b || m_first_last == 11_b)
         {
         m_first_last = 10_b;
@@ -64,69 +90,31 @@ namespace dab
         {
         m_first_last = 00_b;
         }
-      auto parts = split_vector(msc_data_group, packet_length);
-      auto hd_packets = assemble(parts.first, packet_length+5);
-      auto tl_packets = build(parts.second);
-
-      concat_vectors_inplace(hd_packets, tl_packets);
-      return hd_packets;
+      assemble<3>(packets, header, data, full);
+      header += 5;
+      data += full;
+      remaining -= full;
       }
-    else if (len > constants::kPacketDataLengths[2])
+
+    set_first_last();
+    if(remaining > constants::kPacketDataLengths[2])
       {
-      set_first_last();
-      return assemble(msc_data_group, constants::kPacketLengths[3]);
+      assemble<3>(packets, header, data, remaining);
       }
-    else if (len > constants::kPacketDataLengths[1])
+    else if(remaining > constants::kPacketDataLengths[1])
       {
-      set_first_last();
-      return assemble(msc_data_group, constants::kPacketLengths[2]);
+      assemble<2>(packets, header, data, remaining);
       }
-    else if (len > constants::kPacketDataLengths[0])
+    else if(remaining > constants::kPacketDataLengths[0])
       {
-      set_first_last();
-      return assemble(msc_data_group, constants::kPacketLengths[1]);
+      assemble<1>(packets, header, data, remaining);
       }
     else
       {
-      set_first_last();
-      return assemble(msc_data_group, constants::kPacketLengths[0]);
-
+      assemble<0>(packets, header, data, remaining);
       }
 
-    }
-
-  byte_vector_t packet_generator::build_header(std::uint8_t const packet_length, std::uint8_t const useful_data_lenght)
-    {
-    auto header = byte_vector_t{0, 0, 0};
-    // Packet length:
-    switch(packet_length)
-      {
-      case constants::kPacketLengths[3]:
-        header[0] = 11000000_b;
-        break;
-      case constants::kPacketLengths[2]:
-        header[0] = 10000000_b;
-        break;
-      case constants::kPacketLengths[1]:
-        header[0] = 01000000_b;
-        break;
-      case constants::kPacketLengths[0]:
-        header[0] = 00000000_b;
-        break;
-      }
-    // Continuity index:
-    header[0] |= m_continuity_index << 4;
-    m_continuity_index = (m_continuity_index + 1)%4;
-    // First/Last:
-    header[0] |= m_first_last << 2;
-    // Address:
-    header[0] |= 00000011_b & (kAddress >> 8);
-    header[1] = kAddress;
-    // Command:
-    header[2] = 0_b << 7;
-    // Useful data length:
-    header[2] |= useful_data_lenght;
-    return header;
+    return packets;
     }
 
   void packet_generator::set_first_last()
@@ -141,14 +129,25 @@ namespace dab
       }
     }
 
-  byte_vector_t packet_generator::assemble(byte_vector_t & msc_data_group, std::uint8_t packet_length)
+  template<std::size_t LengthClass>
+  void packet_generator::assemble(buffer_chain & packets, std::uint8_t * overhead, std::uint8_t const * data,
+                                  std::uint8_t length)
     {
-    auto packets = byte_vector_t(0);
-    auto header = build_header(packet_length, msc_data_group.size());
-    concat_vectors_inplace(packets, header, msc_data_group);
-    concat_vectors_inplace(packets, byte_vector_t(packet_length - 5 - msc_data_group.size(), 0x00)); //Padding
-    auto crc = genCRC16(packets);
-    concat_vectors_inplace(packets, crc);
-    return packets;
+    static std::uint8_t const padding[constants::kPacketLengths[3]]{};
+    auto const padding_length = packet_encoder<LengthClass>::kDataLength - length;
+
+    packet_encoder<LengthClass>::encode_header(overhead, kHeaderPatterns[LengthClass], m_continuity_index, m_first_last, length);
+    m_continuity_index = (m_continuity_index + 1) % 4;
+
+    auto crc = updateCRC16(0xFFFF, overhead, 3);
+    crc = updateCRC16(crc, data, length);
+    crc = ~updateCRC16(crc, padding, padding_length);
+    overhead[3] = crc >> 8;
+    overhead[4] = crc;
+
+    packets.append(overhead, 3);
+    packets.append(data, length);
+    packets.append(padding, padding_length);
+    packets.append(overhead + 3, 2);
     }
 }
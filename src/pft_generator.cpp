@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/edi/pft_generator.h"
+#include "dab/util/crc16.h"
+#include "dab/util/vector_helpers.h"
+
+#include <dab/types/common_types.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace dab
+  {
+
+  using namespace internal;
+
+  namespace
+    {
+
+    std::size_t divide_round_up(std::size_t dividend, std::size_t divisor)
+      {
+      return (dividend + divisor - 1) / divisor;
+      }
+
+    }
+
+  std::uint8_t constexpr pft_generator::kMaxRecoverable;
+
+  pft_generator::pft_generator(std::uint8_t recoverable, std::size_t max_fragment_size)
+    : kRecoverable{recoverable},
+      kMaxFragmentSize{max_fragment_size}
+    {
+    if(!kMaxFragmentSize || kMaxFragmentSize > 0x3FFF)
+      {
+      throw std::invalid_argument{"PFT fragment size out of range"};
+      }
+
+    if(kRecoverable > kMaxRecoverable)
+      {
+      throw std::invalid_argument{"PFT cannot recover from more than " + std::to_string(kMaxRecoverable) + " lost fragments"};
+      }
+    }
+
+  byte_vector_t pft_generator::build_header(std::uint32_t index, std::uint32_t count, std::size_t length, std::uint8_t chunk_length, std::uint8_t padding) const
+    {
+    auto header = byte_vector_t{'P', 'F'};
+    header.reserve(16);
+    header.push_back(m_sequence >> 8);
+    header.push_back(m_sequence);
+    header.push_back(index >> 16);
+    header.push_back(index >> 8);
+    header.push_back(index);
+    header.push_back(count >> 16);
+    header.push_back(count >> 8);
+    header.push_back(count);
+
+    // FEC flag, address flag and fragment length:
+    auto const plen = length | (kRecoverable ? 0x8000 : 0);
+    header.push_back(plen >> 8);
+    header.push_back(plen);
+
+    if(kRecoverable)
+      {
+      header.push_back(chunk_length);
+      header.push_back(padding);
+      }
+
+    concat_vectors_inplace(header, genCRC16(header));
+    return header;
+    }
+
+  std::vector<byte_vector_t> pft_generator::build(byte_vector_t const & af_packet)
+    {
+    auto block = byte_vector_t{};
+    auto chunk_length = std::size_t{};
+    auto padding = std::size_t{};
+    auto payload_size = kMaxFragmentSize;
+
+    if(kRecoverable)
+      {
+      // Split into c chunks of k bytes each, the last one being padded with z zeros
+      auto const chunks = divide_round_up(af_packet.size(), reed_solomon_encoder::kDataLength);
+      chunk_length = divide_round_up(af_packet.size(), chunks);
+      padding = chunks * chunk_length - af_packet.size();
+
+      block.reserve(chunks * (chunk_length + reed_solomon_encoder::kParityLength));
+      for(auto offset = std::size_t{}; offset < af_packet.size(); offset += chunk_length)
+        {
+        auto const length = std::min(chunk_length, af_packet.size() - offset);
+        block.insert(block.end(), af_packet.begin() + offset, af_packet.begin() + offset + length);
+        block.resize(block.size() + chunk_length - length);
+
+        auto const parity_offset = block.size();
+        block.resize(block.size() + reed_solomon_encoder::kParityLength);
+        m_encoder.encode(af_packet.data() + offset, length, block.data() + parity_offset);
+        }
+
+      // Any m fragments must not carry more than the parity of the whole block
+      payload_size = std::max<std::size_t>(1, std::min(payload_size, chunks * reed_solomon_encoder::kParityLength / (kRecoverable + 1)));
+      }
+    else
+      {
+      block = af_packet;
+      }
+
+    auto const count = divide_round_up(block.size(), payload_size);
+    auto const fragment_size = divide_round_up(block.size(), count);
+    auto fragments = std::vector<byte_vector_t>(count);
+
+    for(auto index = std::size_t{}; index < count; ++index)
+      {
+      auto & fragment = fragments[index];
+
+      if(kRecoverable)
+        {
+        // Interleave the block, so that a lost fragment only costs each chunk a few bytes
+        fragment = build_header(index, count, fragment_size, chunk_length, padding);
+        fragment.reserve(fragment.size() + fragment_size);
+        for(auto position = index; position < fragment_size * count; position += count)
+          {
+          fragment.push_back(position < block.size() ? block[position] : 0);
+          }
+        }
+      else
+        {
+        auto const begin = std::min(block.size(), index * fragment_size);
+        auto const end = std::min(block.size(), begin + fragment_size);
+        fragment = build_header(index, count, end - begin, 0, 0);
+        fragment.insert(fragment.end(), block.begin() + begin, block.begin() + end);
+        }
+      }
+
+    ++m_sequence;
+    return fragments;
+    }
+
+  }
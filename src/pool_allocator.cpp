@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/types/pool_allocator.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace pool
+      {
+
+      namespace
+        {
+
+        std::size_t constexpr kSmallestBlock{64};
+        std::size_t constexpr kClassCount{11};
+        std::size_t constexpr kBatchSize{32};
+        std::size_t constexpr kCacheLimit{2 * kBatchSize};
+
+        static_assert(kSmallestBlock << (kClassCount - 1) == kLargestBlock, "the size classes must end at the largest block");
+
+        std::atomic<std::uint64_t> g_systemAllocations{};
+
+        /**
+         * A free block, linked through its first bytes
+         */
+        struct block
+          {
+          block * next;
+          };
+
+        /**
+         * A singly linked list of free blocks of one size class
+         */
+        struct free_list
+          {
+          void push(block * free)
+            {
+            free->next = head;
+            head = free;
+            ++length;
+            }
+
+          block * pop()
+            {
+            auto const taken = head;
+            head = head->next;
+            --length;
+            return taken;
+            }
+
+          /**
+           * Move up to count blocks to another list
+           */
+          void move(free_list & target, std::size_t count)
+            {
+            while(count-- && head)
+              {
+              target.push(pop());
+              }
+            }
+
+          block * head{};
+          std::size_t length{};
+          };
+
+        std::size_t size_class(std::size_t size)
+          {
+          auto index = std::size_t{};
+          while((kSmallestBlock << index) < size)
+            {
+            ++index;
+            }
+          return index;
+          }
+
+        /**
+         * The blocks shared by all threads, exchanged with the thread caches in batches
+         */
+        struct depot
+          {
+          std::mutex mutex{};
+          std::array<free_list, kClassCount> lists{};
+          };
+
+        depot & shared_depot()
+          {
+          // Never destroyed, threads may still return blocks during static destruction
+          static auto const instance = new depot{};
+          return *instance;
+          }
+
+        /**
+         * The free blocks of a single thread, handed back to the depot when the thread ends
+         */
+        struct thread_cache
+          {
+          ~thread_cache()
+            {
+            auto & shared = shared_depot();
+            auto lock = std::unique_lock<std::mutex>{shared.mutex};
+            for(auto index = std::size_t{}; index < kClassCount; ++index)
+              {
+              lists[index].move(shared.lists[index], lists[index].length);
+              }
+            }
+
+          void * allocate(std::size_t index)
+            {
+            auto & list = lists[index];
+            if(!list.head)
+              {
+              auto & shared = shared_depot();
+              auto lock = std::unique_lock<std::mutex>{shared.mutex};
+              shared.lists[index].move(list, kBatchSize);
+              }
+
+            if(list.head)
+              {
+              return list.pop();
+              }
+
+            g_systemAllocations.fetch_add(1, std::memory_order_relaxed);
+            return ::operator new(kSmallestBlock << index);
+            }
+
+          void deallocate(void * free, std::size_t index)
+            {
+            auto & list = lists[index];
+            list.push(static_cast<block *>(free));
+
+            if(list.length > kCacheLimit)
+              {
+              auto & shared = shared_depot();
+              auto lock = std::unique_lock<std::mutex>{shared.mutex};
+              list.move(shared.lists[index], kBatchSize);
+              }
+            }
+
+          std::array<free_list, kClassCount> lists{};
+          };
+
+        thread_local thread_cache t_cache{};
+
+        }
+
+      void * allocate(std::size_t size)
+        {
+        if(size > kLargestBlock)
+          {
+          g_systemAllocations.fetch_add(1, std::memory_order_relaxed);
+          return ::operator new(size);
+          }
+
+        return t_cache.allocate(size_class(size));
+        }
+
+      void deallocate(void * block, std::size_t size)
+        {
+        if(size > kLargestBlock)
+          {
+          ::operator delete(block);
+          return;
+          }
+
+        t_cache.deallocate(block, size_class(size));
+        }
+
+      std::uint64_t system_allocations()
+        {
+        return g_systemAllocations.load(std::memory_order_relaxed);
+        }
+
+      }
+
+    }
+
+  }
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/util/reed_solomon.h"
+
+#include <algorithm>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    std::size_t constexpr reed_solomon_encoder::kDataLength;
+    std::size_t constexpr reed_solomon_encoder::kParityLength;
+
+    reed_solomon_encoder::reed_solomon_encoder()
+      {
+      auto value = 1u;
+      for(auto power = 0u; power < 255; ++power)
+        {
+        m_exp[power] = value;
+        m_exp[power + 255] = value;
+        m_log[value] = power;
+        value <<= 1;
+        if(value & 0x100)
+          {
+          value ^= 0x11D;
+          }
+        }
+
+      // g(x) = (x + a^0)(x + a^1)...(x + a^47), highest order coefficient first
+      m_generator[0] = 1;
+      for(auto root = 0u; root < kParityLength; ++root)
+        {
+        for(auto idx = root + 1; idx > 0; --idx)
+          {
+          m_generator[idx] ^= multiply(m_generator[idx - 1], m_exp[root]);
+          }
+        }
+      }
+
+    void reed_solomon_encoder::encode(std::uint8_t const * data, std::size_t length, std::uint8_t * parity) const
+      {
+      std::fill(parity, parity + kParityLength, 0);
+
+      for(auto idx = std::size_t{}; idx < kDataLength; ++idx)
+        {
+        auto const feedback = std::uint8_t((idx < length ? data[idx] : 0) ^ parity[0]);
+        std::copy(parity + 1, parity + kParityLength, parity);
+        parity[kParityLength - 1] = 0;
+
+        if(feedback)
+          {
+          for(auto term = std::size_t{}; term < kParityLength; ++term)
+            {
+            parity[term] ^= multiply(feedback, m_generator[term + 1]);
+            }
+          }
+        }
+      }
+
+    std::uint8_t reed_solomon_encoder::multiply(std::uint8_t left, std::uint8_t right) const
+      {
+      return left && right ? m_exp[m_log[left] + m_log[right]] : 0;
+      }
+
+    }
+
+  }
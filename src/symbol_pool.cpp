@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/types/symbol_pool.h"
+
+#include <stdexcept>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace
+      {
+
+      std::size_t free_list_capacity(std::size_t buffers)
+        {
+        auto capacity = std::size_t{2};
+        while(capacity < buffers)
+          {
+          capacity <<= 1;
+          }
+        return capacity;
+        }
+
+      }
+
+    symbol_pool::symbol_pool(types::transmission_mode const & mode, std::size_t buffers)
+      : m_symbolSize{mode.symbol_bits},
+        m_capacity{buffers},
+        m_storage{new float[m_symbolSize * buffers]},
+        m_inUse{new std::atomic<bool>[buffers]()},
+        m_free{free_list_capacity(buffers)}
+      {
+      if(!buffers)
+        {
+        throw std::invalid_argument{"symbol pool must hold at least one buffer"};
+        }
+
+      for(auto index = std::uint32_t{}; index < buffers; ++index)
+        {
+        m_free.try_enqueue(std::uint32_t{index});
+        }
+      }
+
+    bool symbol_pool::try_acquire(symbol_buffer_t & buffer)
+      {
+      auto index = std::uint32_t{};
+      if(!m_free.try_dequeue(index))
+        {
+        return false;
+        }
+
+      m_inUse[index].store(true, std::memory_order_relaxed);
+      buffer = symbol_buffer_t{m_storage.get() + index * m_symbolSize, index};
+      return true;
+      }
+
+    void symbol_pool::release(symbol_buffer_t buffer)
+      {
+      if(buffer.index >= m_capacity || buffer.data != m_storage.get() + buffer.index * m_symbolSize)
+        {
+        throw std::invalid_argument{"symbol buffer does not belong to this pool"};
+        }
+
+      // Queueing a buffer twice would hand it to two owners at once
+      if(!m_inUse[buffer.index].exchange(false, std::memory_order_relaxed))
+        {
+        throw std::invalid_argument{"symbol buffer was already released"};
+        }
+
+      m_free.try_enqueue(std::uint32_t{buffer.index});
+      }
+
+    std::size_t symbol_pool::symbol_size() const
+      {
+      return m_symbolSize;
+      }
+
+    std::size_t symbol_pool::capacity() const
+      {
+      return m_capacity;
+      }
+
+    std::size_t symbol_pool::approximate_available() const
+      {
+      return m_free.approximate_size();
+      }
+
+    }
+
+  }
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/modulation/time_interleaver.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace
+      {
+
+      std::size_t constexpr kDepth {16};
+
+      /**
+       * The delay in logical frames of the bits with index i mod 16
+       */
+      std::uint8_t constexpr kDelays[] {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+
+      }
+
+    time_interleaver::time_interleaver(std::size_t size)
+      : m_delay_lines(size / 8 * kDepth)
+      {
+      if(!size || size % 8)
+        {
+        throw std::invalid_argument{"the codeword of the time interleaver must be a multiple of 8 bytes"};
+        }
+
+      // A word holds eight bytes, alternating between the first and second half of the 16 bit indices
+      for(auto delay = std::size_t{}; delay < kDepth; ++delay)
+        {
+        std::uint8_t bytes[8] {};
+        for(auto byte = 0u; byte < 8; ++byte)
+          {
+          for(auto bit = 0u; bit < 8; ++bit)
+            {
+            if(kDelays[(byte % 2) * 8 + bit] == delay)
+              {
+              bytes[byte] |= 0x80 >> bit;
+              }
+            }
+          }
+        std::memcpy(&m_masks[delay], bytes, sizeof(bytes));
+        }
+      }
+
+    void time_interleaver::interleave(std::uint8_t const * input, std::uint8_t * output)
+      {
+      auto const current = m_frame;
+      m_frame = (m_frame + 1) % kDepth;
+
+      for(auto line = m_delay_lines.data(); line != m_delay_lines.data() + m_delay_lines.size(); line += kDepth)
+        {
+        std::memcpy(line + current, input, 8);
+        input += 8;
+
+        auto word = std::uint64_t{};
+        for(auto delay = std::size_t{}; delay < kDepth; ++delay)
+          {
+          word |= line[(current - delay) % kDepth] & m_masks[delay];
+          }
+
+        std::memcpy(output, &word, 8);
+        output += 8;
+        }
+      }
+
+    std::size_t time_interleaver::size() const
+      {
+      return m_delay_lines.size() / kDepth * 8;
+      }
+
+    }
+
+  }
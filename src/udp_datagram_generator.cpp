@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/ip/udp_datagram_generator.h"
+#include "dab/constants/header_compression_constants.h"
+#include "dab/util/internet_checksum.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace dab
+  {
+
+  using namespace internal;
+
+  namespace
+    {
+
+    void put_word(std::uint8_t * target, std::uint16_t value)
+      {
+      target[0] = value >> 8;
+      target[1] = value;
+      }
+
+    void put_long(std::uint8_t * target, std::uint32_t value)
+      {
+      put_word(target, value >> 16);
+      put_word(target + 2, value);
+      }
+
+    }
+
+  udp_datagram_generator::udp_datagram_generator(header_context const & context) : kContext(context)
+    {
+    }
+
+  byte_vector_t udp_datagram_generator::build(byte_vector_t const & payload) const
+    {
+    auto datagram = iobuf{};
+    datagram.assign(payload.begin(), payload.end());
+    build(datagram);
+    return byte_vector_t{datagram.begin(), datagram.end()};
+    }
+
+  void udp_datagram_generator::build(iobuf & payload) const
+    {
+    auto const header_size = std::size_t{constants::kIPv4HeaderSize} + constants::kUDPHeaderSize;
+    if(payload.size() > 0xFFFF - header_size)
+      {
+      throw std::length_error{"payload too large for a UDP datagram"};
+      }
+
+    auto const payload_size = payload.size();
+    auto const ip = payload.prepend(header_size);
+    std::fill(ip, ip + header_size, 0);
+    auto const udp = ip + constants::kIPv4HeaderSize;
+    auto const udp_length = std::uint16_t(constants::kUDPHeaderSize + payload_size);
+
+    // IPv4 header:
+    ip[0] = 0x45; //Version and header length
+    put_word(ip + 2, constants::kIPv4HeaderSize + udp_length); //Total length
+    put_word(ip + 4, constants::kIPv4DefaultIdentification); //Identification
+    ip[8] = constants::kIPv4DefaultTTL;
+    ip[9] = constants::kIPProtocolUDP;
+    put_long(ip + 12, kContext.source_address);
+    put_long(ip + 16, kContext.destination_address);
+    put_word(ip + 10, ones_complement_fold(ones_complement_add(0, ip, constants::kIPv4HeaderSize)));
+
+    // UDP header and checksum over the pseudo header, the UDP header and the payload:
+    put_word(udp, kContext.source_port);
+    put_word(udp + 2, kContext.destination_port);
+    put_word(udp + 4, udp_length);
+
+    auto sum = ones_complement_add(0, ip + 12, 8);
+    sum += constants::kIPProtocolUDP;
+    sum += udp_length;
+    sum = ones_complement_add(sum, udp, udp_length);
+    auto const checksum = ones_complement_fold(sum);
+    put_word(udp + 6, checksum ? checksum : 0xFFFF);
+    }
+
+  }
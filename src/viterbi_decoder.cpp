@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dab/util/viterbi_decoder.h"
+#include "dab/constants/coding_constants.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <immintrin.h>
+#define DABIP_VITERBI_SSE2
+#endif
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    namespace
+      {
+
+      std::size_t constexpr kStates {64};
+      float constexpr kSoftScale {32};
+      std::int16_t constexpr kSoftLimit {127};
+      std::int16_t constexpr kUnreachable {-16384};
+
+      /**
+       * The sign of the soft bits in the branch metric of each butterfly j, for the outputs of the first and
+       * last polynomial combined, and for the second and third one
+       *
+       * Butterfly j joins the states j and j + 32 into the states 2j and 2j + 1. The branch from j to 2j
+       * has the metric m, the branches to 2j + 1 and from j + 32 to 2j have -m, as every polynomial taps both
+       * the current and the oldest bit.
+       */
+      struct branch_signs
+        {
+        branch_signs()
+          {
+          auto const taps = std::array<std::uint8_t, 3>{{constants::kMotherCodeTaps[0], constants::kMotherCodeTaps[1],
+                                                         constants::kMotherCodeTaps[2]}};
+          for(auto term = std::size_t{}; term < taps.size(); ++term)
+            {
+            for(auto butterfly = std::size_t{}; butterfly < kStates / 2; ++butterfly)
+              {
+              values[term][butterfly] = __builtin_parity(2 * butterfly & taps[term]) ? -1 : 1;
+              }
+            }
+          }
+
+        alignas(32) std::int16_t values[3][kStates / 2];
+        };
+
+      branch_signs const & signs()
+        {
+        static auto const table = branch_signs{};
+        return table;
+        }
+
+      void forward_generic(std::int16_t const * soft, std::size_t steps, std::uint64_t * decisions)
+        {
+        auto const & sign = signs().values;
+        auto metrics = std::array<int, kStates>{};
+        auto next = std::array<int, kStates>{};
+        std::fill(metrics.begin() + 1, metrics.end(), kUnreachable);
+
+        for(auto step = std::size_t{}; step < steps; ++step, soft += 4)
+          {
+          auto const first = soft[0] + soft[3];
+          auto decision = std::uint64_t{};
+          for(auto butterfly = std::size_t{}; butterfly < kStates / 2; ++butterfly)
+            {
+            auto const branch = sign[0][butterfly] * first + sign[1][butterfly] * soft[1] + sign[2][butterfly] * soft[2];
+            auto const upper = metrics[butterfly];
+            auto const lower = metrics[butterfly + kStates / 2];
+
+            next[2 * butterfly] = std::max(upper + branch, lower - branch);
+            next[2 * butterfly + 1] = std::max(upper - branch, lower + branch);
+            decision |= std::uint64_t{lower - branch > upper + branch} << (2 * butterfly);
+            decision |= std::uint64_t{lower + branch > upper - branch} << (2 * butterfly + 1);
+            }
+
+          decisions[step] = decision;
+          for(auto state = std::size_t{}; state < kStates; ++state)
+            {
+            metrics[state] = next[state] - next[0];
+            }
+          }
+        }
+
+#ifdef DABIP_VITERBI_SSE2
+      void forward_sse2(std::int16_t const * soft, std::size_t steps, std::uint64_t * decisions)
+        {
+        auto const & sign = signs().values;
+        __m128i metrics[8];
+        __m128i next[8];
+        for(auto & vector : metrics)
+          {
+          vector = _mm_set1_epi16(kUnreachable);
+          }
+        metrics[0] = _mm_insert_epi16(metrics[0], 0, 0);
+
+        for(auto step = std::size_t{}; step < steps; ++step, soft += 4)
+          {
+          auto const first = _mm_set1_epi16(soft[0] + soft[3]);
+          auto const second = _mm_set1_epi16(soft[1]);
+          auto const third = _mm_set1_epi16(soft[2]);
+          auto decision = std::uint64_t{};
+
+          for(auto quarter = 0; quarter < 4; ++quarter)
+            {
+            auto const branch = _mm_add_epi16(_mm_add_epi16(
+                _mm_mullo_epi16(_mm_load_si128(reinterpret_cast<__m128i const *>(sign[0] + 8 * quarter)), first),
+                _mm_mullo_epi16(_mm_load_si128(reinterpret_cast<__m128i const *>(sign[1] + 8 * quarter)), second)),
+                _mm_mullo_epi16(_mm_load_si128(reinterpret_cast<__m128i const *>(sign[2] + 8 * quarter)), third));
+
+            auto const upper = metrics[quarter];
+            auto const lower = metrics[quarter + 4];
+            auto const upper_even = _mm_adds_epi16(upper, branch);
+            auto const lower_even = _mm_subs_epi16(lower, branch);
+            auto const upper_odd = _mm_subs_epi16(upper, branch);
+            auto const lower_odd = _mm_adds_epi16(lower, branch);
+
+            // Butterflies 8q to 8q + 7 produce the states 16q to 16q + 15, interleaving even and odd ones
+            auto const even = _mm_max_epi16(upper_even, lower_even);
+            auto const odd = _mm_max_epi16(upper_odd, lower_odd);
+            next[2 * quarter] = _mm_unpacklo_epi16(even, odd);
+            next[2 * quarter + 1] = _mm_unpackhi_epi16(even, odd);
+
+            auto const even_decisions = _mm_cmpgt_epi16(lower_even, upper_even);
+            auto const odd_decisions = _mm_cmpgt_epi16(lower_odd, upper_odd);
+            auto const packed = _mm_packs_epi16(_mm_unpacklo_epi16(even_decisions, odd_decisions),
+                                                _mm_unpackhi_epi16(even_decisions, odd_decisions));
+            decision |= std::uint64_t(_mm_movemask_epi8(packed)) << (16 * quarter);
+            }
+
+          decisions[step] = decision;
+          auto const base = _mm_set1_epi16(_mm_extract_epi16(next[0], 0));
+          for(auto idx = 0; idx < 8; ++idx)
+            {
+            metrics[idx] = _mm_subs_epi16(next[idx], base);
+            }
+          }
+        }
+
+      __attribute__((target("avx2")))
+      void forward_avx2(std::int16_t const * soft, std::size_t steps, std::uint64_t * decisions)
+        {
+        auto const & sign = signs().values;
+        __m256i metrics[4];
+        __m256i next[4];
+        for(auto & vector : metrics)
+          {
+          vector = _mm256_set1_epi16(kUnreachable);
+          }
+        metrics[0] = _mm256_insert_epi16(metrics[0], 0, 0);
+
+        for(auto step = std::size_t{}; step < steps; ++step, soft += 4)
+          {
+          auto const first = _mm256_set1_epi16(soft[0] + soft[3]);
+          auto const second = _mm256_set1_epi16(soft[1]);
+          auto const third = _mm256_set1_epi16(soft[2]);
+          auto decision = std::uint64_t{};
+
+          for(auto half = 0; half < 2; ++half)
+            {
+            auto const branch = _mm256_add_epi16(_mm256_add_epi16(
+                _mm256_sign_epi16(first, _mm256_load_si256(reinterpret_cast<__m256i const *>(sign[0] + 16 * half))),
+                _mm256_sign_epi16(second, _mm256_load_si256(reinterpret_cast<__m256i const *>(sign[1] + 16 * half)))),
+                _mm256_sign_epi16(third, _mm256_load_si256(reinterpret_cast<__m256i const *>(sign[2] + 16 * half))));
+
+            auto const upper = metrics[half];
+            auto const lower = metrics[half + 2];
+            auto const upper_even = _mm256_adds_epi16(upper, branch);
+            auto const lower_even = _mm256_subs_epi16(lower, branch);
+            auto const upper_odd = _mm256_subs_epi16(upper, branch);
+            auto const lower_odd = _mm256_adds_epi16(lower, branch);
+
+            // Unpacking works within 128 bit lanes, yielding the states 32h + 0 to 7 and 16 to 23, and 8 to 15 and 24 to 31
+            auto const even = _mm256_max_epi16(upper_even, lower_even);
+            auto const odd = _mm256_max_epi16(upper_odd, lower_odd);
+            auto const low = _mm256_unpacklo_epi16(even, odd);
+            auto const high = _mm256_unpackhi_epi16(even, odd);
+            next[2 * half] = _mm256_permute2x128_si256(low, high, 0x20);
+            next[2 * half + 1] = _mm256_permute2x128_si256(low, high, 0x31);
+
+            // Packing works within lanes as well, which puts the decisions back into the order of the states
+            auto const even_decisions = _mm256_cmpgt_epi16(lower_even, upper_even);
+            auto const odd_decisions = _mm256_cmpgt_epi16(lower_odd, upper_odd);
+            auto const packed = _mm256_packs_epi16(_mm256_unpacklo_epi16(even_decisions, odd_decisions),
+                                                   _mm256_unpackhi_epi16(even_decisions, odd_decisions));
+            decision |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(packed))) << (32 * half);
+            }
+
+          decisions[step] = decision;
+          auto const base = _mm256_set1_epi16(_mm256_extract_epi16(next[0], 0));
+          for(auto idx = 0; idx < 4; ++idx)
+            {
+            metrics[idx] = _mm256_subs_epi16(next[idx], base);
+            }
+          }
+        }
+#endif
+
+      }
+
+    viterbi_decoder::viterbi_decoder(puncturing_profile_t const & profile)
+      : m_output_size{},
+        m_kernel{forward_generic}
+      {
+      // Record which bits of the mother code survived the puncturing, in the order they were transmitted
+      auto mother_bit = std::uint32_t{};
+      auto const keep = [&](std::uint32_t vector, std::size_t bits){
+        for(auto bit = std::size_t{}; bit < bits; ++bit, ++mother_bit)
+          {
+          if(vector >> (31 - bit) & 1)
+            {
+            m_positions.push_back(mother_bit);
+            }
+          }
+      };
+
+      for(auto const & run : profile)
+        {
+        if(!run.vector || run.vector > 24)
+          {
+          throw std::invalid_argument{"puncturing vector index must be between 1 and 24"};
+          }
+
+        for(auto byte = std::size_t{}; byte < run.blocks * 4; ++byte)
+          {
+          keep(constants::kPuncturingVectors[run.vector - 1], 32);
+          }
+        m_output_size += run.blocks * 4;
+        }
+      keep(constants::kTailPuncturingVector, constants::kTailBits);
+
+      m_soft.resize(mother_bit);
+      m_decisions.resize(mother_bit / 4);
+
+#ifdef DABIP_VITERBI_SSE2
+      m_kernel = __builtin_cpu_supports("avx2") ? forward_avx2 : forward_sse2;
+#endif
+      }
+
+    std::size_t viterbi_decoder::input_size() const
+      {
+      return m_positions.size();
+      }
+
+    std::size_t viterbi_decoder::output_size() const
+      {
+      return m_output_size;
+      }
+
+    void viterbi_decoder::decode(float const * soft, std::uint8_t * output)
+      {
+      std::fill(m_soft.begin(), m_soft.end(), 0);
+      for(auto const position : m_positions)
+        {
+        auto const value = std::lrint(*soft++ * kSoftScale);
+        m_soft[position] = std::max<long>(-kSoftLimit, std::min<long>(kSoftLimit, value));
+        }
+
+      m_kernel(m_soft.data(), m_decisions.size(), m_decisions.data());
+
+      // The tail returns the encoder to the zero state, from where the surviving path is followed back
+      std::memset(output, 0, m_output_size);
+      auto state = std::uint64_t{};
+      for(auto step = m_decisions.size(); step-- > 0;)
+        {
+        if(step < m_output_size * 8 && state & 1)
+          {
+          output[step / 8] |= 0x80 >> step % 8;
+          }
+        state = state >> 1 | (m_decisions[step] >> state & 1) << 5;
+        }
+      }
+
+    }
+
+  }
@@ -0,0 +1,462 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/header_compression/header_compressor.h>
+#include <dab/header_compression/header_context.h>
+#include <dab/ip/udp_datagram_generator.h>
+#include <dab/msc_data_group/msc_data_group_generator.h>
+#include <dab/packet/packet_generator.h>
+#include <dab/types/buffer_chain.h>
+
+#include <injector/capture_ingest.h>
+
+#include <tins/sniffer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+
+  /**
+   * The interval at which the sub-channel carries a frame of bitrate * 3 bytes
+   */
+  std::int64_t constexpr kFrameMicroseconds{24000};
+
+  /**
+   * A datagram of the trace, or the packets it was encoded into
+   */
+  struct datagram_t
+    {
+    std::int64_t time;
+    std::size_t size;
+    };
+
+  struct options_t
+    {
+    std::string trace{};
+    std::uint16_t port{};
+    bool compress_headers{};
+    double max_delay{100};
+    std::vector<std::uint32_t> bitrates{};
+    };
+
+  struct result_t
+    {
+    std::uint32_t bitrate{};
+    std::uint64_t frames{};
+    std::uint64_t padding{};
+    std::uint64_t max_backlog{};
+    std::int64_t drain{};
+    std::vector<std::int64_t> delays{};
+    };
+
+  std::uint16_t read_16(std::uint8_t const * data)
+    {
+    return data[0] << 8 | data[1];
+    }
+
+  bool ends_with(std::string const & text, std::string const & suffix)
+    {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+  /**
+   * Read a trace of "size,time" lines, with the time in seconds. Empty lines and lines starting with '#' are ignored.
+   */
+  std::vector<datagram_t> read_csv(std::string const & file)
+    {
+    auto input = std::ifstream{file};
+    if(!input)
+      {
+      throw std::runtime_error{"cannot open trace '" + file + "'"};
+      }
+
+    auto trace = std::vector<datagram_t>{};
+    auto line = std::string{};
+    for(auto number = 1; std::getline(input, line); ++number)
+      {
+      if(line.empty() || line[0] == '#')
+        {
+        continue;
+        }
+
+      auto fields = std::istringstream{line};
+      auto size = std::size_t{};
+      auto separator = char{};
+      auto seconds = double{};
+      if(!(fields >> size >> separator >> seconds) || separator != ',')
+        {
+        // Allow a header line naming the columns
+        if(trace.empty() && number == 1)
+          {
+          continue;
+          }
+        throw std::runtime_error{"malformed line " + std::to_string(number) + " in trace '" + file + "'"};
+        }
+
+      trace.push_back(datagram_t{static_cast<std::int64_t>(std::llround(seconds * 1e6)), size});
+      }
+
+    std::stable_sort(trace.begin(), trace.end(), [](datagram_t const & left, datagram_t const & right){
+      return left.time < right.time;
+    });
+    return trace;
+    }
+
+  /**
+   * Read the UDP payload sizes and capture times of the unfragmented UDP datagrams of a capture file
+   */
+  std::vector<datagram_t> read_pcap(std::string const & file, std::uint16_t port)
+    {
+    Tins::FileSniffer sniffer{file, port ? "udp dst port " + std::to_string(port) : "udp"};
+    auto const handle = sniffer.get_pcap_handle();
+    auto const link_type = sniffer.link_type();
+
+    auto trace = std::vector<datagram_t>{};
+    pcap_pkthdr * header{};
+    u_char const * frame{};
+    while(true)
+      {
+      auto const result = pcap_next_ex(handle, &header, &frame);
+      if(result == -2)
+        {
+        break;
+        }
+      else if(result < 0)
+        {
+        throw std::runtime_error{pcap_geterr(handle)};
+        }
+
+      auto offset = std::size_t{};
+      auto length = std::size_t{};
+      if(!injector::find_ip_datagram(link_type, frame, header->caplen, offset, length))
+        {
+        continue;
+        }
+
+      auto const ip = frame + offset;
+      auto const header_length = std::size_t(ip[0] & 0x0F) * 4;
+      if(ip[9] != 17 || (read_16(ip + 6) & 0x3FFF) || length < header_length + 8 || read_16(ip + header_length + 4) < 8)
+        {
+        continue;
+        }
+
+      auto const time = std::int64_t{header->ts.tv_sec} * 1000000 + header->ts.tv_usec;
+      trace.push_back(datagram_t{time, std::size_t{read_16(ip + header_length + 4)} - 8u});
+      }
+
+    return trace;
+    }
+
+  /**
+   * Run the trace through the encoders of the injector, yielding the number of packet bytes of every datagram
+   */
+  std::vector<datagram_t> encode(std::vector<datagram_t> const & trace, bool compress_headers, std::uint64_t & payload)
+    {
+    auto context = dab::header_context{};
+    auto const datagrams = dab::udp_datagram_generator{context};
+    auto const header_compressor = dab::header_compressor{0};
+    auto grouper = dab::msc_data_group_generator{};
+    auto packer = dab::packet_generator{1};
+
+    auto encoded = std::vector<datagram_t>{};
+    encoded.reserve(trace.size());
+    for(auto const & datagram : trace)
+      {
+      // The payload bytes only need to differ between datagrams for the data group repetition to reset
+      auto data = dab::iobuf(datagram.size);
+      std::fill(data.begin(), data.end(), static_cast<std::uint8_t>(encoded.size()));
+
+      if(compress_headers)
+        {
+        header_compressor.build(data);
+        }
+      else
+        {
+        datagrams.build(data);
+        }
+      grouper.build(data);
+
+      encoded.push_back(datagram_t{datagram.time, packer.build(std::move(data)).size()});
+      payload += datagram.size;
+      }
+
+    return encoded;
+    }
+
+  /**
+   * Feed the packets into a sub-channel of the given bitrate, which takes the next bitrate * 3 bytes every 24ms
+   */
+  result_t simulate(std::vector<datagram_t> const & packets, std::uint32_t bitrate)
+    {
+    auto result = result_t{};
+    result.bitrate = bitrate;
+    result.delays.reserve(packets.size());
+
+    auto const frame_size = std::uint64_t{bitrate} * 3;
+    auto const start = packets.front().time;
+    auto const last_arrival = packets.back().time;
+    auto pending = std::deque<datagram_t>{};
+    auto backlog = std::uint64_t{};
+    auto sent = std::uint64_t{};
+    auto next = std::size_t{};
+    auto frame = std::int64_t{};
+
+    while(next < packets.size() || !pending.empty())
+      {
+      // Idle frames carry nothing but padding, skip ahead to the one taking the next datagram
+      if(pending.empty() && packets[next].time > start + frame * kFrameMicroseconds)
+        {
+        frame = (packets[next].time - start + kFrameMicroseconds - 1) / kFrameMicroseconds;
+        }
+
+      auto const tick = start + frame * kFrameMicroseconds;
+      for(; next < packets.size() && packets[next].time <= tick; ++next)
+        {
+        pending.push_back(packets[next]);
+        backlog += packets[next].size;
+        }
+      result.max_backlog = std::max(result.max_backlog, backlog);
+
+      // A datagram is delayed until the frame carrying its last byte
+      auto capacity = frame_size;
+      while(capacity && !pending.empty())
+        {
+        auto & front = pending.front();
+        auto const taken = std::min<std::uint64_t>(capacity, front.size);
+        capacity -= taken;
+        backlog -= taken;
+        sent += taken;
+        front.size -= taken;
+        if(!front.size)
+          {
+          result.delays.push_back(tick - front.time);
+          pending.pop_front();
+          }
+        }
+
+      ++frame;
+      if(next == packets.size() && pending.empty())
+        {
+        result.drain = std::max<std::int64_t>(tick - last_arrival, 0);
+        }
+      }
+
+    result.frames = frame;
+    result.padding = result.frames * frame_size - sent;
+    std::sort(result.delays.begin(), result.delays.end());
+    return result;
+    }
+
+  double quantile(std::vector<std::int64_t> const & sorted, double quantile)
+    {
+    auto const index = static_cast<std::size_t>(std::ceil(quantile * sorted.size()));
+    return sorted[std::min(std::max<std::size_t>(index, 1), sorted.size()) - 1] / 1000.0;
+    }
+
+  std::vector<std::uint32_t> parse_bitrates(std::string const & list)
+    {
+    auto bitrates = std::vector<std::uint32_t>{};
+    auto fields = std::istringstream{list};
+    auto field = std::string{};
+    while(std::getline(fields, field, ','))
+      {
+      auto const dash = field.find('-');
+      auto const first = std::stoul(field.substr(0, dash));
+      auto const last = dash == std::string::npos ? first : std::stoul(field.substr(dash + 1));
+      for(auto bitrate = first; bitrate <= last; bitrate += 8)
+        {
+        if(!bitrate || bitrate % 8 || bitrate > 1824)
+          {
+          throw std::invalid_argument{"bitrates must be multiples of 8 kbit/s up to 1824 kbit/s"};
+          }
+        bitrates.push_back(bitrate);
+        }
+      }
+
+    std::sort(bitrates.begin(), bitrates.end());
+    bitrates.erase(std::unique(bitrates.begin(), bitrates.end()), bitrates.end());
+    return bitrates;
+    }
+
+  options_t parse_options(int argc, char * * argv)
+    {
+    auto options = options_t{};
+    options.bitrates = parse_bitrates("8-512");
+
+    for(auto idx = 1; idx < argc; ++idx)
+      {
+      auto const argument = std::string{argv[idx]};
+      auto const value = [&]{
+        if(idx + 1 == argc)
+          {
+          throw std::invalid_argument{"missing value for " + argument};
+          }
+        return std::string{argv[++idx]};
+      };
+
+      if(argument == "--bitrates")
+        {
+        options.bitrates = parse_bitrates(value());
+        }
+      else if(argument == "--port")
+        {
+        options.port = static_cast<std::uint16_t>(std::stoul(value()));
+        }
+      else if(argument == "--max-delay")
+        {
+        options.max_delay = std::stod(value());
+        }
+      else if(argument == "--compress-headers")
+        {
+        options.compress_headers = true;
+        }
+      else if(options.trace.empty() && argument[0] != '-')
+        {
+        options.trace = argument;
+        }
+      else
+        {
+        throw std::invalid_argument{"unexpected argument " + argument};
+        }
+      }
+
+    if(options.trace.empty() || options.bitrates.empty())
+      {
+      throw std::invalid_argument{"usage: capacity-planner <trace.pcap|trace.csv> [--port port] [--compress-headers] "
+                                  "[--bitrates 8-512,768] [--max-delay ms]"};
+      }
+    return options;
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Size a packet mode sub-channel for a traffic trace
+ *
+ * Reads a capture file, or a CSV file of "size,time" lines, and encodes its datagrams with the data group and
+ * packet generators of the injector. The resulting packet stream is then fed into simulated sub-channels of
+ * the candidate bitrates on all cores. For every bitrate, the padding overhead and the percentiles of the
+ * delay until a datagram is sent are reported, followed by the smallest bitrate meeting the delay target.
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const options = parse_options(argc, argv);
+  auto const trace = ends_with(options.trace, ".csv") ? read_csv(options.trace) : read_pcap(options.trace, options.port);
+  if(trace.empty())
+    {
+    throw std::runtime_error{"the trace does not contain any datagrams"};
+    }
+
+  auto payload = std::uint64_t{};
+  auto const packets = encode(trace, options.compress_headers, payload);
+  auto encoded = std::uint64_t{};
+  for(auto const & datagram : packets)
+    {
+    encoded += datagram.size;
+    }
+
+  auto results = std::vector<result_t>(options.bitrates.size());
+  std::atomic<std::size_t> next{0};
+  auto workers = std::vector<std::thread>{};
+  auto const threads = std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u), results.size());
+  for(auto idx = std::size_t{}; idx < threads; ++idx)
+    {
+    workers.emplace_back([&]{
+      for(auto candidate = next++; candidate < results.size(); candidate = next++)
+        {
+        results[candidate] = simulate(packets, options.bitrates[candidate]);
+        }
+    });
+    }
+  for(auto & worker : workers)
+    {
+    worker.join();
+    }
+
+  auto const duration = std::max<std::int64_t>(packets.back().time - packets.front().time, kFrameMicroseconds);
+  auto const mean_rate = encoded * 8.0 / duration * 1000;
+  std::cout << std::fixed << std::setprecision(1) <<
+      "Trace: " << trace.size() << " datagram(s), " << payload << " payload bytes over " << duration / 1e6 << "s\n" <<
+      "Packets: " << encoded << " bytes (" << 100.0 * (encoded - payload) / encoded << "% headers, CRCs and packet padding), mean rate " <<
+      mean_rate << " kbit/s\n\n";
+
+  std::cout << " kbit/s  padding     p50 ms     p90 ms     p99 ms     max ms   backlog B   drain s\n";
+  auto required = std::uint32_t{};
+  for(auto const & result : results)
+    {
+    auto const p99 = quantile(result.delays, 0.99);
+    if(!required && p99 <= options.max_delay)
+      {
+      required = result.bitrate;
+      }
+
+    std::cout << std::setw(7) << result.bitrate <<
+        std::setw(8) << 100.0 * result.padding / (result.frames * result.bitrate * 3) << '%' <<
+        std::setw(11) << quantile(result.delays, 0.5) <<
+        std::setw(11) << quantile(result.delays, 0.9) <<
+        std::setw(11) << p99 <<
+        std::setw(11) << quantile(result.delays, 1.0) <<
+        std::setw(12) << result.max_backlog <<
+        std::setw(10) << result.drain / 1e6 << '\n';
+    }
+
+  std::cout << '\n';
+  if(required)
+    {
+    std::cout << "Required capacity: " << required << " kbit/s for a p99 delay of at most " << options.max_delay << "ms" << std::endl;
+    }
+  else
+    {
+    std::cout << "None of the candidate bitrates keeps the p99 delay below " << options.max_delay << "ms" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/coding_constants.h>
+#include <dab/constants/transmission_modes.h>
+#include <dab/util/convolutional_encoder.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+  {
+
+  using namespace dab::internal;
+
+  /**
+   * Encode and puncture bit by bit, following the shift register and puncturing vectors of the standard
+   */
+  void reference_encode(puncturing_profile_t const & profile, std::uint8_t const * input, std::uint8_t * output)
+    {
+    auto shift_register = 0u;
+    auto written = std::size_t{};
+    auto const emit = [&](std::uint32_t vector, std::size_t bits){
+      for(auto bit = std::size_t{}; bit < bits; ++bit)
+        {
+        shift_register = (shift_register >> 1) | (bit < 8 && input ? (*input >> (7 - bit) & 1) << 6 : 0);
+        for(auto output_index = 0u; output_index < 4; ++output_index)
+          {
+          auto const polynomial = constants::kMotherCodePolynomials[output_index];
+          if(vector >> (31 - (bit * 4 + output_index)) & 1)
+            {
+            auto const value = __builtin_parity(shift_register & polynomial);
+            output[written / 8] = (output[written / 8] & ~(0x80 >> written % 8)) | value << (7 - written % 8);
+            ++written;
+            }
+          }
+        }
+    };
+
+    for(auto const & run : profile)
+      {
+      for(auto byte = std::size_t{}; byte < run.blocks * 4; ++byte, ++input)
+        {
+        emit(constants::kPuncturingVectors[run.vector - 1], 8);
+        }
+      }
+    input = nullptr;
+    emit(constants::kTailPuncturingVector, 6);
+    }
+
+  template<typename Encoder>
+  double bits_per_second(std::uint64_t frames, std::size_t input_bits, Encoder && encode)
+    {
+    auto const start = std::chrono::steady_clock::now();
+    for(auto frame = std::uint64_t{}; frame < frames; ++frame)
+      {
+      encode(frame);
+      }
+    return frames * input_bits / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Compare the table driven convolutional encoder with bit by bit encoding for a full ensemble
+ *
+ * The ensemble consists of the FIC of a mode I CIF and twelve 96 kbit/s EEP 3-A sub-channels, filling all
+ * 864 capacity units with 1152 kbit/s. Usage: convolutional-encoder-bench [frames]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const frames = argc > 1 ? std::stoull(argv[1]) : 2000ull;
+
+  auto profiles = std::vector<puncturing_profile_t>{fic_profile(dab::kTransmissionMode1)};
+  for(auto subchannel = 0; subchannel < 12; ++subchannel)
+    {
+    profiles.push_back(eep_profile(96, 0x22));
+    }
+
+  auto encoders = std::vector<convolutional_encoder>{};
+  auto inputs = std::vector<std::vector<std::uint8_t>>{};
+  auto input_bits = std::size_t{};
+  for(auto const & profile : profiles)
+    {
+    encoders.emplace_back(profile);
+    inputs.emplace_back(encoders.back().input_size());
+    for(auto idx = std::size_t{}; idx < inputs.back().size(); ++idx)
+      {
+      inputs.back()[idx] = idx * 37 + inputs.size();
+      }
+    input_bits += inputs.back().size() * 8;
+    }
+
+  if(encoders[0].output_size() * 8 != dab::kTransmissionMode1.punctured_codeword_size)
+    {
+    throw std::logic_error{"the FIC encoder does not produce a punctured codeword"};
+    }
+
+  auto reference_outputs = std::vector<std::vector<std::uint8_t>>{};
+  auto table_outputs = std::vector<std::vector<std::uint8_t>>{};
+  for(auto const & encoder : encoders)
+    {
+    reference_outputs.emplace_back(encoder.output_size());
+    table_outputs.emplace_back(encoder.output_size());
+    }
+
+  auto const reference = bits_per_second(frames / 10 + 1, input_bits, [&](std::uint64_t frame){
+    for(auto idx = std::size_t{}; idx < profiles.size(); ++idx)
+      {
+      inputs[idx][0] = frame;
+      reference_encode(profiles[idx], inputs[idx].data(), reference_outputs[idx].data());
+      }
+  });
+  for(auto idx = std::size_t{}; idx < encoders.size(); ++idx)
+    {
+    encoders[idx].encode(inputs[idx].data(), table_outputs[idx].data());
+    }
+
+  if(reference_outputs != table_outputs)
+    {
+    throw std::logic_error{"the table driven encoder produced a different codeword"};
+    }
+
+  auto const table = bits_per_second(frames, input_bits, [&](std::uint64_t frame){
+    for(auto idx = std::size_t{}; idx < encoders.size(); ++idx)
+      {
+      inputs[idx][0] = frame;
+      encoders[idx].encode(inputs[idx].data(), table_outputs[idx].data());
+      }
+  });
+
+  // The ensemble encodes one CIF every 24ms
+  auto const ensemble_rate = input_bits / 0.024;
+  std::cout << std::fixed << std::setprecision(1) <<
+      "ensemble    " << ensemble_rate / 1e6 << "Mbit/s\n" <<
+      "reference   " << reference / 1e6 << "Mbit/s (" << reference / ensemble_rate << "x real time)\n" <<
+      "table       " << table / 1e6 << "Mbit/s (" << table / ensemble_rate << "x real time, " <<
+      table / reference << "x)" << std::endl;
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/eti_constants.h>
+#include <dab/util/energy_dispersal.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+  {
+
+  /**
+   * Scramble a frame by clocking the PRBS register bit by bit, kept as a baseline
+   */
+  void reference_dispersal(std::uint8_t * data, std::size_t length)
+    {
+    auto state = 0x1FFu;
+    for(auto idx = std::size_t{}; idx < length; ++idx)
+      {
+      auto byte = 0u;
+      for(auto bit = 0; bit < 8; ++bit)
+        {
+        auto const output = (state >> 4 ^ state >> 8) & 1;
+        state = (state << 1 | output) & 0x1FF;
+        byte = byte << 1 | output;
+        }
+      data[idx] ^= byte;
+      }
+    }
+
+  template<typename Scrambler>
+  double bytes_per_second(std::uint64_t frames, std::vector<std::uint8_t> & frame, Scrambler && scramble)
+    {
+    auto const start = std::chrono::steady_clock::now();
+    for(auto idx = std::uint64_t{}; idx < frames; ++idx)
+      {
+      scramble(frame.data(), frame.size());
+      }
+    return frames * frame.size() / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Compare the precomputed energy dispersal with clocking the PRBS register for every frame
+ *
+ * A frame defaults to the whole MSC of an ensemble, 864 capacity units of 64 bits each, which is what a
+ * baseband generator scrambles every 24ms. Usage: energy-dispersal-bench [frames] [frame bytes]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const frames = argc > 1 ? std::stoull(argv[1]) : 20000ull;
+  auto const length = argc > 2 ? std::stoull(argv[2]) : dab::internal::constants::kCapacityUnits * 8ull;
+  if(!length)
+    {
+    throw std::invalid_argument{"the frame must not be empty"};
+    }
+
+  auto reference_frame = std::vector<std::uint8_t>(length);
+  for(auto idx = std::size_t{}; idx < length; ++idx)
+    {
+    reference_frame[idx] = idx * 13;
+    }
+  auto precomputed_frame = reference_frame;
+
+  auto const dispersal = dab::internal::energy_dispersal{length};
+  auto const reference = bytes_per_second(frames, reference_frame, reference_dispersal);
+  auto const precomputed = bytes_per_second(frames, precomputed_frame, [&](std::uint8_t * data, std::size_t){
+    dispersal.apply(data);
+  });
+
+  if(reference_frame != precomputed_frame)
+    {
+    throw std::logic_error{"the precomputed sequence differs from the PRBS"};
+    }
+
+  // The full ensemble carries the frame every 24ms
+  auto const ensemble_rate = length / 0.024;
+  std::cout << std::fixed << std::setprecision(1) <<
+      "reference   " << reference / 1e6 << "MB/s (" << std::setprecision(0) << reference / ensemble_rate << "x real time)\n" <<
+      std::setprecision(1) <<
+      "precomputed " << precomputed / 1e6 << "MB/s (" << std::setprecision(0) << precomputed / ensemble_rate << "x real time, " <<
+      std::setprecision(1) << precomputed / reference << "x)" << std::endl;
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
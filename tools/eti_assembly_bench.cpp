@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/eti/eti_frame_generator.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+  {
+
+  /**
+   * Assemble frames for the given sub-channels, filling each one the way an output fills it every 24ms
+   */
+  double frames_per_second(dab::internal::types::transmission_mode const & mode, std::vector<dab::eti_subchannel> const & subchannels,
+                           std::uint64_t count, std::uint64_t & digest)
+    {
+    auto generator = dab::eti_frame_generator{mode, subchannels};
+    auto source = std::vector<std::uint8_t>(8192);
+    for(auto idx = std::size_t{}; idx < source.size(); ++idx)
+      {
+      source[idx] = idx * 13;
+      }
+
+    auto const start = std::chrono::steady_clock::now();
+    for(auto frame = std::uint64_t{}; frame < count; ++frame)
+      {
+      for(auto subchannel = std::size_t{}; subchannel < subchannels.size(); ++subchannel)
+        {
+        std::memcpy(generator.subchannel_data(subchannel), source.data() + (frame + subchannel) % 1024,
+                    generator.subchannel_size(subchannel));
+        }
+      auto const & built = generator.build();
+      digest = digest * 31 + built[(frame * 7) % built.size()];
+      }
+    return count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Measure the ETI(NI) frame assembly for several packet mode sub-channels in every transmission mode
+ *
+ * The sub-channels are EEP 3-A protected and laid out back to back in the CIF. Usage:
+ * eti-assembly-bench [frames] [sub-channels] [bitrate]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const count = argc > 1 ? std::stoull(argv[1]) : 200000ull;
+  auto const streams = argc > 2 ? std::stoul(argv[2]) : 8ul;
+  auto const bitrate = static_cast<std::uint16_t>(argc > 3 ? std::stoul(argv[3]) : 96ul);
+
+  // EEP 3-A occupies 6 capacity units per 8 kbit/s
+  auto subchannels = std::vector<dab::eti_subchannel>{};
+  for(auto idx = std::size_t{}; idx < streams; ++idx)
+    {
+    auto const start_address = static_cast<std::uint16_t>(idx * bitrate / 8 * 6);
+    subchannels.push_back(dab::eti_subchannel{{0, static_cast<std::uint8_t>(idx + 1), start_address, 0x22}, bitrate});
+    }
+
+  auto const modes = {dab::kTransmissionMode1, dab::kTransmissionMode2, dab::kTransmissionMode3, dab::kTransmissionMode4};
+  auto digest = std::uint64_t{};
+  for(auto const & mode : modes)
+    {
+    auto const rate = frames_per_second(mode, subchannels, count, digest);
+    std::cout << std::fixed << std::setprecision(1) << "mode " << +mode.id << ": " << rate / 1e3 << "k frames/s, " <<
+        std::setprecision(0) << rate * 0.024 << "x real time\n";
+    }
+  std::cout << "digest " << std::hex << digest << std::endl;
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <injector/configuration.h>
+#include <injector/dispatch.h>
+#include <injector/service.h>
+#include <injector/udp_receiver.h>
+#include <injector/uring_receiver.h>
+
+#include <arpa/inet.h>
+#include <dlfcn.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+  {
+
+  /**
+   * Whether the system calls of the current thread are counted, only set on the receiver threads
+   */
+  thread_local bool t_counted{};
+
+  std::atomic<std::uint64_t> g_asioCalls{};
+
+  template<typename FunctionType>
+  FunctionType next_symbol(char const * name)
+    {
+    return reinterpret_cast<FunctionType>(dlsym(RTLD_NEXT, name));
+    }
+
+  void count()
+    {
+    if(t_counted)
+      {
+      g_asioCalls.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+  }
+
+/*
+ * The system calls ASIO makes while receiving, interposed to count the ones made by the receiver threads
+ */
+extern "C"
+  {
+
+  ssize_t recvmsg(int socket, msghdr * message, int flags)
+    {
+    static auto const next = next_symbol<ssize_t (*)(int, msghdr *, int)>("recvmsg");
+    count();
+    return next(socket, message, flags);
+    }
+
+  ssize_t recvfrom(int socket, void * buffer, size_t length, int flags, sockaddr * address, socklen_t * size)
+    {
+    static auto const next = next_symbol<ssize_t (*)(int, void *, size_t, int, sockaddr *, socklen_t *)>("recvfrom");
+    count();
+    return next(socket, buffer, length, flags, address, size);
+    }
+
+  int epoll_wait(int epoll, epoll_event * events, int size, int timeout)
+    {
+    static auto const next = next_symbol<int (*)(int, epoll_event *, int, int)>("epoll_wait");
+    count();
+    return next(epoll, events, size, timeout);
+    }
+
+  int epoll_ctl(int epoll, int operation, int descriptor, epoll_event * event)
+    {
+    static auto const next = next_symbol<int (*)(int, int, int, epoll_event *)>("epoll_ctl");
+    count();
+    return next(epoll, operation, descriptor, event);
+    }
+
+  ssize_t read(int descriptor, void * buffer, size_t length)
+    {
+    static auto const next = next_symbol<ssize_t (*)(int, void *, size_t)>("read");
+    count();
+    return next(descriptor, buffer, length);
+    }
+
+  ssize_t write(int descriptor, void const * buffer, size_t length)
+    {
+    static auto const next = next_symbol<ssize_t (*)(int, void const *, size_t)>("write");
+    count();
+    return next(descriptor, buffer, length);
+    }
+
+  }
+
+namespace
+  {
+
+  struct result_t
+    {
+    std::uint64_t sent{};
+    std::uint64_t received{};
+    std::uint64_t syscalls{};
+    double seconds{};
+    };
+
+  /**
+   * Send datagrams in bursts to a receiver and count the system calls it makes to receive them
+   */
+  result_t measure(std::string const & backend, std::uint16_t port, std::uint64_t datagrams, std::size_t size, std::size_t burst)
+    {
+    auto config = injector::configuration_t{};
+    auto service = injector::service_configuration_t{};
+    service.name = backend;
+    service.port = port;
+    config.services.push_back(service);
+
+    auto const directory = new injector::service_directory{injector::make_service_table(config)};
+    auto const dispatcher = new injector::dispatcher{1, 1u << 16};
+    auto const receiver = injector::make_udp_receiver(backend, 0, 1, *directory, *dispatcher).release();
+    receiver->update();
+
+    std::thread{[receiver]{
+      t_counted = true;
+      receiver->run();
+    }}.detach();
+
+    // Give the receiver time to open its socket
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+    auto const socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    auto target = sockaddr_in{};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(port);
+    target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    auto const payload = std::vector<char>(size, 'x');
+    auto & queue = *dispatcher->packager_queues()[0];
+    auto datagram = injector::queued_datagram_t{};
+    auto result = result_t{};
+
+    auto const before = backend == "uring" ? injector::uring_enter_calls() : g_asioCalls.load();
+    auto const start = std::chrono::steady_clock::now();
+
+    while(result.sent < datagrams)
+      {
+      auto const batch = std::min<std::uint64_t>(burst, datagrams - result.sent);
+      for(auto idx = std::uint64_t{}; idx < batch; ++idx)
+        {
+        sendto(socket, payload.data(), payload.size(), 0, reinterpret_cast<sockaddr const *>(&target), sizeof(target));
+        }
+      result.sent += batch;
+
+      // Wait for the burst to arrive before sending the next one, giving up on datagrams dropped by the kernel
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{50};
+      while(result.received < result.sent && std::chrono::steady_clock::now() < deadline)
+        {
+        if(queue.approximate_size())
+          {
+          queue.dequeue(datagram);
+          ++result.received;
+          deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{50};
+          }
+        }
+      }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.syscalls = (backend == "uring" ? injector::uring_enter_calls() : g_asioCalls.load()) - before;
+    close(socket);
+    return result;
+    }
+
+  void report(std::string const & backend, result_t const & result)
+    {
+    std::cout << std::left << std::setw(6) << backend << std::right << std::fixed << std::setprecision(3) <<
+        " received " << result.received << "/" << result.sent <<
+        " syscalls " << result.syscalls <<
+        " per datagram " << static_cast<double>(result.syscalls) / std::max<std::uint64_t>(result.received, 1) <<
+        " rate " << std::setprecision(0) << result.received / result.seconds << "/s" << std::endl;
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Compare the system calls per received datagram of the asio and io_uring receivers
+ *
+ * Sends datagrams over the loopback interface in bursts and counts the system calls the receiver thread makes
+ * to receive them. Usage: ingest-syscalls [datagrams] [size] [burst]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const datagrams = argc > 1 ? std::stoull(argv[1]) : 100000ull;
+  auto const size = argc > 2 ? std::stoul(argv[2]) : 512ul;
+  auto const burst = argc > 3 ? std::stoul(argv[3]) : 32ul;
+
+  if(!size || size > 1024 || !burst)
+    {
+    throw std::invalid_argument{"the size must be between 1 and 1024 bytes and the burst must not be empty"};
+    }
+
+  report("asio", measure("asio", 45001, datagrams, size, burst));
+
+  if(!injector::uring_available())
+    {
+    std::cout << "uring  not available" << std::endl;
+    return EXIT_SUCCESS;
+    }
+
+  report("uring", measure("uring", 45002, datagrams, size, burst));
+  return EXIT_SUCCESS;
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/eti_constants.h>
+#include <dab/constants/transmission_modes.h>
+#include <dab/modulation/frequency_interleaver.h>
+#include <dab/modulation/time_interleaver.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+  {
+
+  using namespace dab::internal;
+
+  /**
+   * Delay each bit through a queue of its own, kept as a baseline
+   */
+  struct reference_time_interleaver
+    {
+    explicit reference_time_interleaver(std::size_t size)
+      : m_lines(size * 8, std::vector<std::uint8_t>(16))
+      {
+
+      }
+
+    void interleave(std::uint8_t const * input, std::uint8_t * output)
+      {
+      static std::uint8_t constexpr delays[] {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+      for(auto bit = std::size_t{}; bit < m_lines.size(); ++bit)
+        {
+        auto & line = m_lines[bit];
+        line[m_frame] = input[bit / 8] >> (7 - bit % 8) & 1;
+        auto const delayed = line[(m_frame + 16 - delays[bit % 16]) % 16];
+        output[bit / 8] = (output[bit / 8] & ~(0x80 >> bit % 8)) | delayed << (7 - bit % 8);
+        }
+      m_frame = (m_frame + 1) % 16;
+      }
+
+    private:
+    std::vector<std::vector<std::uint8_t>> m_lines;
+    std::size_t m_frame{};
+    };
+
+  template<typename Interleave>
+  double cifs_per_second(std::uint64_t cifs, Interleave && interleave)
+    {
+    auto const start = std::chrono::steady_clock::now();
+    for(auto cif = std::uint64_t{}; cif < cifs; ++cif)
+      {
+      interleave(cif);
+      }
+    return cifs / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Measure the time interleaving of a full MSC and the frequency interleaving of a CIF in every transmission mode
+ *
+ * Both are reported in CIFs per second and as a multiple of the 24ms a CIF takes on air. Usage:
+ * interleaver-bench [CIFs]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const cifs = argc > 1 ? std::stoull(argv[1]) : 20000ull;
+  auto const cif_size = constants::kCapacityUnits * 8u;
+
+  auto input = std::vector<std::uint8_t>(cif_size);
+  auto reference_output = std::vector<std::uint8_t>(cif_size);
+  auto output = std::vector<std::uint8_t>(cif_size);
+
+  auto reference_interleaver = reference_time_interleaver{cif_size};
+  auto interleaver = time_interleaver{cif_size};
+  auto const reference = cifs_per_second(cifs / 100 + 16, [&](std::uint64_t cif){
+    for(auto idx = std::size_t{}; idx < cif_size; ++idx)
+      {
+      input[idx] = idx * 7 + cif;
+      }
+    reference_interleaver.interleave(input.data(), reference_output.data());
+    interleaver.interleave(input.data(), output.data());
+  });
+
+  if(reference_output != output)
+    {
+    throw std::logic_error{"the time interleaver differs from per bit delay lines"};
+    }
+
+  auto const time = cifs_per_second(cifs, [&](std::uint64_t cif){
+    input[cif % cif_size] = cif;
+    interleaver.interleave(input.data(), output.data());
+  });
+
+  std::cout << std::fixed << std::setprecision(0) <<
+      "time interleaver, reference (and check) " << reference << " CIFs/s (" << reference * 0.024 << "x real time)\n" <<
+      "time interleaver                        " << time << " CIFs/s (" << time * 0.024 << "x real time)\n";
+
+  auto const modes = {dab::kTransmissionMode1, dab::kTransmissionMode2, dab::kTransmissionMode3, dab::kTransmissionMode4};
+  for(auto const & mode : modes)
+    {
+    auto const frequency = frequency_interleaver{mode};
+    auto symbols = std::vector<dab::sample_t>(frequency.symbols_per_cif() * mode.carriers, dab::sample_t{1, -1});
+    auto bins = std::vector<dab::sample_t>(frequency.symbols_per_cif() * mode.fft_length);
+
+    auto const rate = cifs_per_second(cifs, [&](std::uint64_t cif){
+      symbols[cif % symbols.size()] = dab::sample_t(cif, 0);
+      frequency.interleave(symbols.data(), bins.data());
+    });
+
+    std::cout << "frequency interleaver, mode " << +mode.id << "          " << rate << " CIFs/s (" << rate * 0.024 <<
+        "x real time)\n";
+    }
+  std::cout << std::flush;
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/sample_rate.h>
+#include <dab/constants/transmission_modes.h>
+#include <dab/modulation/ofdm_modulator.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+  {
+
+  /**
+   * Modulate frames of pseudo random bits, optionally writing the samples to an IQ file
+   *
+   * @return The achieved multiple of real time
+   */
+  double modulate(dab::internal::types::transmission_mode const & mode, std::uint64_t frames, std::ofstream * file)
+    {
+    auto modulator = dab::ofdm_modulator{mode};
+    dab::sample_queue_t queue{};
+    auto bits = std::vector<std::uint8_t>(modulator.frame_size());
+    auto samples = std::vector<dab::sample_t>(mode.frame_duration);
+    auto state = std::uint32_t{mode.id};
+
+    auto busy = std::chrono::steady_clock::duration{};
+    for(auto frame = std::uint64_t{}; frame < frames; ++frame)
+      {
+      for(auto & byte : bits)
+        {
+        state = state * 1664525 + 1013904223;
+        byte = state >> 24;
+        }
+
+      auto const start = std::chrono::steady_clock::now();
+      modulator.modulate(bits.data(), queue);
+      busy += std::chrono::steady_clock::now() - start;
+
+      queue.dequeue(samples);
+      if(file)
+        {
+        file->write(reinterpret_cast<char const *>(samples.data()), samples.size() * sizeof(dab::sample_t));
+        }
+      }
+
+    auto const on_air = double(frames) * mode.frame_duration / dab::kDefaultSampleRate;
+    return on_air / std::chrono::duration<double>(busy).count();
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Measure the OFDM modulator in every transmission mode, or generate a test IQ file
+ *
+ * Without a mode, all four are measured. With a file, the samples of the given mode are written to it as
+ * interleaved 32 bit floats at 2.048 MS/s. Usage: ofdm-modulator-bench [frames] [mode] [file]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const frames = argc > 1 ? std::stoull(argv[1]) : 100ull;
+  auto const selected = argc > 2 ? std::stoul(argv[2]) : 0ul;
+  if(selected > 4 || (argc > 3 && !selected))
+    {
+    throw std::invalid_argument{"the mode must be between 1 and 4, and is required for writing a file"};
+    }
+
+  auto file = std::ofstream{};
+  if(argc > 3)
+    {
+    file.open(argv[3], std::ios::binary);
+    if(!file)
+      {
+      throw std::runtime_error{"cannot open '" + std::string{argv[3]} + "'"};
+      }
+    }
+
+  auto const modes = {dab::kTransmissionMode1, dab::kTransmissionMode2, dab::kTransmissionMode3, dab::kTransmissionMode4};
+  for(auto const & mode : modes)
+    {
+    if(!selected || selected == mode.id)
+      {
+      auto const speed = modulate(mode, frames, file.is_open() ? &file : nullptr);
+      std::cout << "mode " << +mode.id << ": " << std::fixed << std::setprecision(1) << speed << "x real time\n";
+      }
+    }
+  std::cout << std::flush;
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
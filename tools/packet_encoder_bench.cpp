@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/packet_constants.h>
+#include <dab/packet/packet_encoder.h>
+#include <dab/packet/packet_generator.h>
+#include <dab/types/buffer_chain.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+
+  /**
+   * The header encoding the packet generator used before the specialized encoders, kept as a baseline
+   */
+  void reference_header(std::uint8_t * header, std::uint16_t address, std::uint8_t packet_length, std::uint8_t continuity_index,
+                        std::uint8_t first_last, std::uint8_t useful_data_length)
+    {
+    using namespace dab::internal;
+
+    switch(packet_length)
+      {
+      case constants::kPacketLengths[3]:
+        header[0] = 0xC0;
+        break;
+      case constants::kPacketLengths[2]:
+        header[0] = 0x80;
+        break;
+      case constants::kPacketLengths[1]:
+        header[0] = 0x40;
+        break;
+      case constants::kPacketLengths[0]:
+        header[0] = 0x00;
+        break;
+      }
+    header[0] |= continuity_index << 4;
+    header[0] |= first_last << 2;
+    header[0] |= 0x03 & (address >> 8);
+    header[1] = address;
+    header[2] = 0 << 7;
+    header[2] |= useful_data_length;
+    }
+
+  /**
+   * Encode the headers of a stream of 24 byte packets into a buffer, like the packet generator does
+   */
+  template<typename Encoder>
+  double headers_per_second(std::uint64_t count, std::uint64_t & digest, Encoder && encode)
+    {
+    auto constexpr kLength = dab::internal::packet_encoder<0>::kLength;
+    auto stream = std::vector<std::uint8_t>(4096 * kLength);
+    auto continuity_index = std::uint8_t{};
+
+    auto const start = std::chrono::steady_clock::now();
+    for(auto done = std::uint64_t{}; done < count; done += stream.size() / kLength)
+      {
+      for(auto packet = stream.data(); packet != stream.data() + stream.size(); packet += kLength)
+        {
+        encode(packet, continuity_index, static_cast<std::uint8_t>(done % 20));
+        continuity_index = (continuity_index + 1) % 4;
+        }
+      digest = digest * 31 + stream[(done * 7) % stream.size()];
+      }
+    return count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+  double packets_per_second(std::uint64_t count, std::uint16_t address, std::uint64_t & digest)
+    {
+    auto generator = dab::packet_generator{address};
+    auto group = dab::iobuf{};
+    auto const start = std::chrono::steady_clock::now();
+    for(auto idx = std::uint64_t{}; idx < count; ++idx)
+      {
+      // Data groups of up to 19 bytes fit into a single 24 byte packet
+      group = dab::iobuf(idx % 20);
+      auto const packets = generator.build(std::move(group));
+      for(auto const & segment : packets.segments())
+        {
+        digest = digest * 31 + segment.data[0];
+        }
+      }
+    return count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Compare the specialized DAB packet header encoders with the former field by field encoding
+ *
+ * Measures streams of 24 byte packets, where the header makes up the largest share of the work. Usage:
+ * packet-encoder-bench [packets] [address]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const count = argc > 1 ? std::stoull(argv[1]) : 50000000ull;
+  auto const address = static_cast<std::uint16_t>(argc > 2 ? std::stoul(argv[2]) : 42ul);
+  if(!address || address > 1023)
+    {
+    throw std::invalid_argument{"the address must be between 1 and 1023"};
+    }
+
+  // Read at runtime like the packet length the former encoding switched on
+  std::uint8_t volatile const packet_length = dab::internal::constants::kPacketLengths[0];
+  auto const pattern = dab::internal::packet_encoder<0>::pattern(address);
+  auto reference_digest = std::uint64_t{};
+  auto specialized_digest = std::uint64_t{};
+
+  auto const reference = headers_per_second(count, reference_digest, [&](std::uint8_t * header, std::uint8_t continuity_index, std::uint8_t useful){
+    reference_header(header, address, packet_length, continuity_index, 3, useful);
+  });
+  auto const specialized = headers_per_second(count, specialized_digest, [&](std::uint8_t * header, std::uint8_t continuity_index, std::uint8_t useful){
+    dab::internal::packet_encoder<0>::encode_header(header, pattern, continuity_index, 3, useful);
+  });
+
+  if(reference_digest != specialized_digest)
+    {
+    throw std::logic_error{"the specialized encoder produced different headers"};
+    }
+
+  auto packet_digest = std::uint64_t{};
+  auto const packets = packets_per_second(count / 10, address, packet_digest);
+
+  std::cout << std::fixed << std::setprecision(1) <<
+      "reference headers   " << reference / 1e6 << "M/s\n" <<
+      "specialized headers " << specialized / 1e6 << "M/s (" << std::setprecision(2) << specialized / reference << "x)\n" <<
+      "24 byte packets     " << std::setprecision(1) << packets / 1e6 << "M/s (digest " << std::hex << packet_digest << ")" << std::endl;
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
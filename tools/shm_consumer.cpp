@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/util/crc16.h>
+
+#include <injector/shm_ring_reader.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+/**
+ * @since 1.1.0
+ *
+ * A test consumer for the shared-memory packet ring
+ *
+ * Attaches to the ring written by data-injector, checks the CRC of every packet and periodically
+ * reports the number of packets received, corrupted and lost. With --dump, the packets are written
+ * to stdout as a raw byte stream.
+ */
+int main(int argc, char * * argv) try
+  {
+  auto name = std::string{"/dabdata"};
+  auto dump = false;
+
+  for(auto idx = 1; idx < argc; ++idx)
+    {
+    if(!std::strcmp(argv[idx], "--dump"))
+      {
+      dump = true;
+      }
+    else
+      {
+      name = argv[idx];
+      }
+    }
+
+  injector::shm_ring_reader reader{name};
+  injector::packet_view packet{};
+
+  std::uint64_t received{};
+  std::uint64_t corrupted{};
+  auto last_report = std::chrono::steady_clock::now();
+
+  while(true)
+    {
+    while(reader.next(packet))
+      {
+      // A slot being overwritten may carry any length, too short to even hold the CRC
+      if(packet.length < 2)
+        {
+        ++received;
+        ++corrupted;
+        continue;
+        }
+
+      auto const crc = dab::internal::genCRC16(dab::byte_vector_t{packet.data, packet.data + packet.length - 2});
+      auto const intact = crc[0] == packet.data[packet.length - 2] && crc[1] == packet.data[packet.length - 1];
+
+      if(dump && intact)
+        {
+        std::cout.write(reinterpret_cast<char const *>(packet.data), packet.length);
+        }
+
+      ++received;
+      corrupted += !(intact && reader.valid(packet));
+      }
+
+    reader.wait(std::chrono::milliseconds{500});
+
+    auto const now = std::chrono::steady_clock::now();
+    if(now - last_report >= std::chrono::seconds{1})
+      {
+      std::clog << "received " << received << " corrupted " << corrupted << " lost " << reader.lost() << std::endl;
+      last_report = now;
+      }
+    }
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return 1;
+  }
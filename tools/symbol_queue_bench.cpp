@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/types/common_types.h>
+#include <dab/types/symbol_pool.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+  {
+
+  using namespace dab::internal;
+
+  /**
+   * Fill a symbol with soft bits derived from its number
+   */
+  void produce(float * symbol, std::size_t size, std::uint64_t number)
+    {
+    for(auto idx = std::size_t{}; idx < size; ++idx)
+      {
+      symbol[idx] = static_cast<float>((number + idx) & 0xff);
+      }
+    }
+
+  /**
+   * Reduce a symbol to a checksum, so that the consumer has to read every soft bit
+   */
+  double consume(float const * symbol, std::size_t size)
+    {
+    auto sum = 0.0;
+    for(auto idx = std::size_t{}; idx < size; ++idx)
+      {
+      sum += symbol[idx];
+      }
+    return sum;
+    }
+
+  /**
+   * Transport the symbols as separately allocated vectors, the way symbol_queue_t does
+   */
+  double transport_vectors(std::size_t size, std::uint64_t symbols)
+    {
+    dab::symbol_queue_t transport{};
+    auto producer = std::thread{[&]{
+      for(auto number = std::uint64_t{}; number < symbols; ++number)
+        {
+        auto symbol = std::vector<float>(size);
+        produce(symbol.data(), size, number);
+        transport.enqueue(std::move(symbol));
+        }
+    }};
+
+    auto checksum = 0.0;
+    auto symbol = std::vector<float>{};
+    for(auto number = std::uint64_t{}; number < symbols; ++number)
+      {
+      transport.dequeue(symbol);
+      checksum += consume(symbol.data(), size);
+      }
+
+    producer.join();
+    return checksum;
+    }
+
+  /**
+   * Transport the symbols as handles to buffers of a bounded pool
+   */
+  double transport_handles(types::transmission_mode const & mode, std::size_t buffers, std::uint64_t symbols)
+    {
+    symbol_pool pool{mode, buffers};
+    auto const size = pool.symbol_size();
+
+    dab::pooled_symbol_queue_t queue{};
+    auto producer = std::thread{[&]{
+      for(auto number = std::uint64_t{}; number < symbols; ++number)
+        {
+        auto symbol = dab::symbol_buffer_t{};
+        while(!pool.try_acquire(symbol))
+          {
+          std::this_thread::yield();
+          }
+
+        produce(symbol.data, size, number);
+        queue.enqueue(symbol);
+        }
+    }};
+
+    auto checksum = 0.0;
+    auto symbol = dab::symbol_buffer_t{};
+    for(auto number = std::uint64_t{}; number < symbols; ++number)
+      {
+      queue.dequeue(symbol);
+      checksum += consume(symbol.data, size);
+      pool.release(symbol);
+      }
+
+    producer.join();
+    return checksum;
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Compare transporting mode I symbols from a producer to a consumer thread as vectors and as pooled buffers
+ *
+ * Usage: symbol-queue-bench [symbols] [buffers]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const symbols = argc > 1 ? std::stoull(argv[1]) : 200000ull;
+  auto const buffers = argc > 2 ? std::stoul(argv[2]) : 64ul;
+  auto const & mode = dab::kTransmissionMode1;
+
+  auto start = std::chrono::steady_clock::now();
+  auto const reference = transport_vectors(mode.symbol_bits, symbols);
+  auto const vectorSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  auto const checksum = transport_handles(mode, buffers, symbols);
+  auto const handleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if(checksum != reference)
+    {
+    throw std::logic_error{"pooled transport delivered different symbols"};
+    }
+
+  std::cout << std::fixed << std::setprecision(2) << "vectors: " << symbols / vectorSeconds / 1e6 << "M symbols/s\n" <<
+      "pooled:  " << symbols / handleSeconds / 1e6 << "M symbols/s (" << buffers << " buffers)\n" <<
+      "speedup: " << vectorSeconds / handleSeconds << "x\n";
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }
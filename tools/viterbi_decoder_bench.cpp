@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/util/convolutional_encoder.h>
+#include <dab/util/viterbi_decoder.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+  {
+
+  using namespace dab::internal;
+
+  /**
+   * The encoded CIF of a sub-channel, as noisy soft bits
+   */
+  struct subchannel
+    {
+    puncturing_profile_t profile;
+    std::vector<std::uint8_t> data;
+    std::vector<float> soft;
+    };
+
+  subchannel transmit(puncturing_profile_t const & profile, std::mt19937 & random, float noise)
+    {
+    auto const encoder = convolutional_encoder{profile};
+    auto result = subchannel{profile, std::vector<std::uint8_t>(encoder.input_size()), {}};
+    for(auto & byte : result.data)
+      {
+      byte = random();
+      }
+
+    auto codeword = std::vector<std::uint8_t>(encoder.output_size());
+    encoder.encode(result.data.data(), codeword.data());
+
+    auto distribution = std::normal_distribution<float>{0, noise};
+    for(auto bit = std::size_t{}; bit < codeword.size() * 8; ++bit)
+      {
+      result.soft.push_back((codeword[bit / 8] >> (7 - bit % 8) & 1 ? -1.0f : 1.0f) + distribution(random));
+      }
+    return result;
+    }
+
+  /**
+   * Decode every sub-channel of the ensemble the given number of times, spread over the given number of threads
+   *
+   * @return The number of bit errors in the last decoding
+   */
+  std::size_t decode(std::vector<subchannel> const & ensemble, std::uint64_t cifs, std::size_t threads)
+    {
+    auto errors = std::vector<std::size_t>(threads);
+    auto workers = std::vector<std::thread>{};
+    for(auto worker = std::size_t{}; worker < threads; ++worker)
+      {
+      workers.emplace_back([&, worker]{
+        auto decoders = std::vector<viterbi_decoder>{};
+        auto outputs = std::vector<std::vector<std::uint8_t>>{};
+        for(auto idx = worker; idx < ensemble.size(); idx += threads)
+          {
+          decoders.emplace_back(ensemble[idx].profile);
+          outputs.emplace_back(decoders.back().output_size());
+          }
+
+        for(auto cif = std::uint64_t{}; cif < cifs; ++cif)
+          {
+          for(auto idx = std::size_t{}; idx < decoders.size(); ++idx)
+            {
+            decoders[idx].decode(ensemble[worker + idx * threads].soft.data(), outputs[idx].data());
+            }
+          }
+
+        for(auto idx = std::size_t{}; idx < decoders.size(); ++idx)
+          {
+          auto const & data = ensemble[worker + idx * threads].data;
+          for(auto byte = std::size_t{}; byte < data.size(); ++byte)
+            {
+            errors[worker] += __builtin_popcount(data[byte] ^ outputs[idx][byte]);
+            }
+          }
+      });
+      }
+
+    auto total = std::size_t{};
+    for(auto worker = std::size_t{}; worker < threads; ++worker)
+      {
+      workers[worker].join();
+      total += errors[worker];
+      }
+    return total;
+    }
+
+  }
+
+/**
+ * @since 1.1.0
+ *
+ * Measure the Viterbi decoder on a full ensemble, decoding its sub-channels in parallel
+ *
+ * The ensemble consists of the FIC of a mode I CIF and twelve 96 kbit/s EEP 3-A sub-channels, filling all
+ * 864 capacity units. The soft bits carry gaussian noise of the given standard deviation. Usage:
+ * viterbi-decoder-bench [CIFs] [threads] [noise]
+ */
+int main(int argc, char * * argv) try
+  {
+  auto const cifs = argc > 1 ? std::stoull(argv[1]) : 500ull;
+  auto const threads = argc > 2 ? std::stoul(argv[2]) : 2ul;
+  auto const noise = argc > 3 ? std::stof(argv[3]) : 0.5f;
+  if(!threads)
+    {
+    throw std::invalid_argument{"at least one thread is required"};
+    }
+
+  auto random = std::mt19937{42};
+  auto ensemble = std::vector<subchannel>{transmit(fic_profile(dab::kTransmissionMode1), random, noise)};
+  for(auto idx = 0; idx < 12; ++idx)
+    {
+    ensemble.push_back(transmit(eep_profile(96, 0x22), random, noise));
+    }
+
+  auto bits = std::size_t{};
+  for(auto const & channel : ensemble)
+    {
+    bits += channel.data.size() * 8;
+    }
+
+  for(auto const count : {std::size_t{1}, std::size_t{threads}})
+    {
+    auto const start = std::chrono::steady_clock::now();
+    auto const errors = decode(ensemble, cifs, count);
+    auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << count << " thread(s): " << std::fixed << std::setprecision(1) << cifs * bits / seconds / 1e6 << "Mbit/s, " <<
+        cifs * 0.024 / seconds << "x real time, " << errors << " bit errors in " << bits << " bits" << std::endl;
+    if(count == threads)
+      {
+      break;
+      }
+    }
+  }
+catch(std::exception const & error)
+  {
+  std::cerr << "Error: " << error.what() << '\n';
+  return EXIT_FAILURE;
+  }